@@ -0,0 +1,170 @@
+#include "autopilot.h"
+#include "workstealingpool.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <cmath>
+#include <limits>
+
+namespace {
+// Порядок перебора: при равных оценках остаётся «на месте»
+const int Directions[3] = { 0, -1, 1 };
+
+const double HitPenalty = 1000.0;
+const double GameOverPenalty = 100000.0;
+const double HeartBonus = 200.0;
+// Небольшое притяжение к центру, чтобы не прижиматься к краям поля
+const double CenterWeight = 0.05;
+
+// Ветви двух верхних уровней дерева на один вариант будущего
+const int MaxBranches = 9;
+const int MaxSamples = 16;
+
+// Seed варианта будущего: зависит только от состояния, поэтому решения
+// бота воспроизводимы (запись, подбор сложности)
+quint64 sampleSeed(quint64 stateHash, int sample)
+{
+    quint64 z = stateHash + 0x9e3779b97f4a7c15ULL * static_cast<quint64>(sample + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+}
+
+Autopilot::Autopilot(const AutopilotConfig &autopilotConfig)
+    : config(autopilotConfig)
+{
+    config.segments = qMax(1, config.segments);
+    config.segmentTicks = qMax(1, config.segmentTicks);
+    config.samples = qBound(1, config.samples, MaxSamples);
+    if (config.threads != 1) {
+        pool.reset(new WorkStealingPool(config.threads));
+    }
+}
+
+Autopilot::~Autopilot() = default;
+
+double Autopilot::advance(GameSimulation &state, int direction, int depth, Totals &totals) const
+{
+    const int horizon = config.segments * config.segmentTicks;
+    const int scoreBefore = state.getScore();
+    double value = 0.0;
+
+    SimInput input;
+    input.direction = direction;
+    for (int t = 0; t < config.segmentTicks && !state.isGameOver(); ++t) {
+        state.step(GameSimulation::TickMs, input);
+        ++totals.steps;
+
+        const int tick = depth * config.segmentTicks + t;
+        const double urgency = 1.0 + static_cast<double>(horizon - tick) / horizon;
+        for (const SimEvent &event : state.events()) {
+            if (event.kind == SimEvent::Hit) {
+                value -= HitPenalty * urgency;
+            } else if (event.kind == SimEvent::HeartCollected) {
+                value += HeartBonus;
+            } else if (event.kind == SimEvent::GameOver) {
+                value -= GameOverPenalty * urgency;
+            }
+        }
+    }
+    return value + (state.getScore() - scoreBefore);
+}
+
+double Autopilot::leafValue(const GameSimulation &state) const
+{
+    // Центр активной области: в большом мире совпадает с игроком и тянет
+    // лишь от краёв мира
+    const double center = state.getActiveLeft()
+                          + (state.getWorldParams().activeWidth - GameSimulation::PlayerSize) / 2.0;
+    return -CenterWeight * std::abs(state.getPlayerX() - center);
+}
+
+double Autopilot::search(const GameSimulation &state, int depth, Totals &totals) const
+{
+    if (depth >= config.segments || state.isGameOver()) {
+        ++totals.rollouts;
+        return leafValue(state);
+    }
+
+    double best = -std::numeric_limits<double>::infinity();
+    for (int direction : Directions) {
+        GameSimulation next = state;
+        const double value = advance(next, direction, depth, totals) + search(next, depth + 1, totals);
+        best = qMax(best, value);
+    }
+    return best;
+}
+
+int Autopilot::decide(const GameSimulation &simulation)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Копии без профилировщика: прогоны не должны попадать в замеры игры.
+    // У каждого варианта будущего свой генератор спавна
+    const quint64 stateHash = simulation.stateHash();
+    QVector<GameSimulation> bases(config.samples, simulation);
+    for (int sample = 0; sample < config.samples; ++sample) {
+        bases[sample].setProfiler(nullptr);
+        bases[sample].clearEvents();
+        bases[sample].reseedSpawns(sampleSeed(stateHash, sample));
+    }
+
+    // Задачи — ветви двух верхних уровней (до 9) в каждом варианте,
+    // каждая досчитывает своё поддерево
+    const int parallelDepth = qMin(2, config.segments);
+    const int branches = parallelDepth == 2 ? MaxBranches : 3;
+    const int tasks = branches * config.samples;
+    double values[MaxBranches * MaxSamples];
+    Totals totals[MaxBranches * MaxSamples];
+
+    const auto runBranch = [this, &bases, &values, &totals, parallelDepth, branches](int task) {
+        const int branch = task % branches;
+        GameSimulation state = bases[task / branches];
+        double value = advance(state, Directions[branch % 3], 0, totals[task]);
+        if (parallelDepth == 2 && !state.isGameOver()) {
+            value += advance(state, Directions[branch / 3], 1, totals[task]);
+        }
+        values[task] = value + search(state, parallelDepth, totals[task]);
+    };
+
+    if (pool) {
+        for (int task = 0; task < tasks; ++task) {
+            pool->submit([&runBranch, task] { runBranch(task); });
+        }
+        pool->waitForAll();
+    } else {
+        for (int task = 0; task < tasks; ++task) {
+            runBranch(task);
+        }
+    }
+
+    // Оценка первого отрезка: в каждом варианте будущего берётся лучшее
+    // продолжение, затем варианты усредняются. Решение определяет только
+    // первый отрезок и пересматривается на каждом шаге
+    double directionValues[3] = { 0.0, 0.0, 0.0 };
+    for (int sample = 0; sample < config.samples; ++sample) {
+        for (int first = 0; first < 3; ++first) {
+            double best = -std::numeric_limits<double>::infinity();
+            for (int branch = first; branch < branches; branch += 3) {
+                best = qMax(best, values[sample * branches + branch]);
+            }
+            directionValues[first] += best / config.samples;
+        }
+    }
+    int bestDirection = 0;
+    double bestValue = -std::numeric_limits<double>::infinity();
+    for (int first = 0; first < 3; ++first) {
+        if (directionValues[first] > bestValue) {
+            bestValue = directionValues[first];
+            bestDirection = Directions[first];
+        }
+    }
+    stats = AutopilotStats();
+    for (int task = 0; task < tasks; ++task) {
+        stats.rollouts += static_cast<int>(totals[task].rollouts);
+        stats.steps += static_cast<int>(totals[task].steps);
+    }
+    stats.decisionNs = timer.nsecsElapsed();
+    return bestDirection;
+}
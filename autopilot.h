@@ -0,0 +1,64 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include <QtGlobal>
+#include <memory>
+#include "gamesimulation.h"
+
+class WorkStealingPool;
+
+// Параметры поиска: горизонт — segments отрезков по segmentTicks тактов,
+// на каждом отрезке направление постоянно (влево, на месте, вправо)
+struct AutopilotConfig {
+    int segments = 4;
+    int segmentTicks = 12;
+    int samples = 4;          // сколько вариантов будущего спавна усредняется
+    int threads = 0;          // 0 — по числу ядер, 1 — без пула потоков
+};
+
+// Работа последнего решения автопилота (оверлей F3)
+struct AutopilotStats {
+    int rollouts = 0;         // просмотренные последовательности (листья дерева)
+    int steps = 0;            // шаги симуляции во всех прогонах
+    qint64 decisionNs = 0;
+};
+
+// Игрок-бот с поиском вперёд.
+// Перебирает все последовательности направлений на горизонте деревом:
+// копия GameSimulation продвигается на отрезок и копируется снова для
+// каждого продолжения, так что общие префиксы считаются один раз.
+// Каждая копия — полная копия массивов ObstacleStore (первый же шаг
+// пишет в них), поэтому дерево небольшое: 81 лист на вариант будущего
+// при настройках по умолчанию, сотни прогонов на решение, а не тысячи.
+// Бот не знает будущих волн: генератор спавна в прогонах пересеян,
+// оценка ветви — среднее по samples вариантам будущего спавна.
+// Верхние уровни дерева распределяются по пулу потоков.
+class Autopilot
+{
+public:
+    explicit Autopilot(const AutopilotConfig &config = AutopilotConfig());
+    ~Autopilot();
+
+    // Направление для следующего шага simulation
+    int decide(const GameSimulation &simulation);
+
+    const AutopilotStats &getStats() const { return stats; }
+
+private:
+    struct Totals {
+        quint64 rollouts = 0;
+        quint64 steps = 0;
+    };
+
+    // Оценка отрезка: очки, жизни и штраф за столкновения (тем больше, чем раньше)
+    double advance(GameSimulation &state, int direction, int depth, Totals &totals) const;
+    // Лучшая оценка поддерева начиная с глубины depth
+    double search(const GameSimulation &state, int depth, Totals &totals) const;
+    double leafValue(const GameSimulation &state) const;
+
+    AutopilotConfig config;
+    std::unique_ptr<WorkStealingPool> pool;
+    AutopilotStats stats;
+};
+
+#endif // AUTOPILOT_H
@@ -0,0 +1,293 @@
+#include "benchmark.h"
+#include "game.h"
+#include "spritecache.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGraphicsPixmapItem>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QKeyEvent>
+
+namespace {
+// Сценарий игрока: каждые 60 тактов влево, на месте, вправо
+int scriptedDirection(int tick)
+{
+    return (tick / 60) % 3 - 1;
+}
+
+int keyForDirection(int direction)
+{
+    return direction < 0 ? Qt::Key_Left : Qt::Key_Right;
+}
+
+// Эталон для сверки масок: перебор пикселей a, b сдвинута на offset
+bool pixelsOverlap(const CollisionMask &a, const CollisionMask &b, const QPoint &offset)
+{
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            if (a.testPixel(x, y) && b.testPixel(x - offset.x(), y - offset.y())) return true;
+        }
+    }
+    return false;
+}
+
+QJsonObject sectionJson(const SectionStats &stats)
+{
+    QJsonObject object;
+    object["p50"] = stats.p50;
+    object["p95"] = stats.p95;
+    object["p99"] = stats.p99;
+    object["samples"] = stats.samples;
+    return object;
+}
+}
+
+QJsonObject Benchmark::run(const BenchmarkConfig &config)
+{
+    return config.render ? runRendered(config) : runHeadless(config);
+}
+
+QJsonObject Benchmark::runHeadless(const BenchmarkConfig &config)
+{
+    Profiler profiler(qMax(1, config.ticks));
+
+    GameSimulation simulation;
+    simulation.setCollisionMasks(SpriteCache::instance().collisionMasks());
+    simulation.setDifficultyParams(config.difficulty);
+    simulation.setWorldParams(config.world);
+    simulation.setInvulnerable(true);
+    simulation.reset(config.seed);
+
+    GameRng typeRng(config.seed + 1);
+    QElapsedTimer elapsed;
+    const int totalTicks = config.warmupTicks + config.ticks;
+
+    for (int tick = 0; tick < totalTicks; ++tick) {
+        if (tick == config.warmupTicks) {
+            profiler.reset();
+            simulation.setProfiler(&profiler);
+            elapsed.start();
+        }
+        // Поддержание заданного числа препятствий. Это нагрузка стенда, а не
+        // игры: она не замеряется, чтобы не смешиваться со спавном в шаге
+        while (simulation.getObstacles().aliveCount() < config.obstacles) {
+            simulation.spawnObject(typeRng.bounded(1, 5));
+        }
+
+        Profiler *active = tick >= config.warmupTicks ? &profiler : nullptr;
+        ProfileScope tickScope(active, Profiler::Tick);
+
+        SimInput input;
+        input.direction = scriptedDirection(tick);
+        simulation.step(GameSimulation::TickMs, input);
+    }
+
+    const double elapsedMs = elapsed.nsecsElapsed() / 1e6;
+    const CollisionStats &collisions = simulation.getCollisionStats();
+    profiler.setCounter(Profiler::LiveObstacles, simulation.getObstacles().aliveCount());
+    profiler.setCounter(Profiler::SpriteRasterizations, static_cast<qint64>(SpriteCache::instance().misses()));
+    profiler.setCounter(Profiler::CandidatePairs, collisions.candidatePairs);
+    profiler.setCounter(Profiler::NarrowTests, collisions.narrowTests);
+
+    QJsonObject result = report(config, profiler, elapsedMs, simulation.getObstacles().aliveCount());
+    result["mode"] = QStringLiteral("headless");
+    return result;
+}
+
+QJsonObject Benchmark::runRendered(const BenchmarkConfig &config)
+{
+    Game game;
+    game.stopGame();
+    game.setRenderBackend(config.directRender ? Game::DirectBackend : Game::SceneBackend);
+    game.getSimulation().setDifficultyParams(config.difficulty);
+    game.getSimulation().setInvulnerable(true);
+    game.setWorldParams(config.world);
+    game.resetSession(config.seed);
+    // Таймер не сработает без цикла событий; кадры задаются вручную
+    game.startGame();
+
+    Profiler &profiler = game.getProfiler();
+    profiler = Profiler(qMax(1, config.ticks));
+
+    QImage frame(game.size(), QImage::Format_ARGB32_Premultiplied);
+    GameRng typeRng(config.seed + 1);
+    // Отдельный генератор: вспышки не должны сдвигать последовательность
+    // типов, иначе спавн отличался бы от безголового прогона
+    GameRng particleRng(config.seed + 2);
+    QElapsedTimer elapsed;
+    int direction = 0;
+    const int totalTicks = config.warmupTicks + config.ticks;
+
+    for (int tick = 0; tick < totalTicks; ++tick) {
+        if (tick == config.warmupTicks) {
+            profiler.reset();
+            elapsed.start();
+        }
+
+        // Ввод идёт тем же путём, что и с клавиатуры
+        const int wanted = scriptedDirection(tick);
+        if (wanted != direction) {
+            if (direction != 0) {
+                QKeyEvent release(QEvent::KeyRelease, keyForDirection(direction), Qt::NoModifier);
+                QCoreApplication::sendEvent(&game, &release);
+            }
+            if (wanted != 0) {
+                QKeyEvent press(QEvent::KeyPress, keyForDirection(wanted), Qt::NoModifier);
+                QCoreApplication::sendEvent(&game, &press);
+            }
+            direction = wanted;
+        }
+
+        // Добор препятствий не замеряется, как и в runHeadless()
+        while (game.getObjectCount() < config.obstacles) {
+            game.spawnObject(typeRng.bounded(1, 5));
+        }
+
+        // Нагрузка частицами: вспышки искр в случайных точках экрана у игрока
+        ParticleSystem &particles = game.getParticles();
+        const GameSimulation &simulation = game.getSimulation();
+        const int screenLeft = static_cast<int>(simulation.getActiveLeft());
+        while (particles.size() < qMin(config.particles, particles.capacity())) {
+            particles.burst(ParticleSystem::Spark, screenLeft + particleRng.bounded(0, GameSimulation::FieldWidth),
+                            particleRng.bounded(0, GameSimulation::FieldHeight), 500);
+        }
+
+        game.advanceFrame(GameSimulation::TickMs);
+        game.render(&frame);
+    }
+
+    const double elapsedMs = elapsed.nsecsElapsed() / 1e6;
+    QJsonObject result = report(config, profiler, elapsedMs, game.getObjectCount());
+    result["mode"] = QStringLiteral("render");
+    result["renderer"] = config.directRender ? QStringLiteral("direct") : QStringLiteral("scene");
+    return result;
+}
+
+QJsonObject Benchmark::report(const BenchmarkConfig &config, const Profiler &profiler,
+                              double elapsedMs, int finalObstacles)
+{
+    QJsonObject result;
+    result["ticks"] = config.ticks;
+    result["warmupTicks"] = config.warmupTicks;
+    result["obstaclesTarget"] = config.obstacles;
+    result["particlesTarget"] = config.particles;
+    result["spawnIntervalMs"] = config.difficulty.spawnIntervalMs;
+    result["spawnCount"] = config.difficulty.spawnCount;
+    result["seed"] = QString::number(config.seed);
+    result["worldWidth"] = config.world.width;
+    result["elapsedMs"] = elapsedMs;
+    result["ticksPerSecond"] = elapsedMs > 0.0 ? config.ticks * 1000.0 / elapsedMs : 0.0;
+    result["finalObstacles"] = finalObstacles;
+
+    // Подготовка спрайтов при запуске (растеризация и загрузка в QPixmap)
+    const SpritePreparation &sprites = SpriteCache::instance().preparation();
+    QJsonObject spritesJson;
+    spritesJson["images"] = sprites.images;
+    spritesJson["threads"] = sprites.threads;
+    spritesJson["rasterMs"] = sprites.rasterMs;
+    spritesJson["uploadMs"] = sprites.uploadMs;
+    spritesJson["totalMs"] = sprites.totalMs;
+    result["spritePreparation"] = spritesJson;
+
+    QJsonObject sections;
+    for (int i = 0; i < Profiler::SectionCount; ++i) {
+        const Profiler::Section section = static_cast<Profiler::Section>(i);
+        sections[QString::fromLatin1(Profiler::sectionName(section))] = sectionJson(profiler.stats(section));
+    }
+    result["sectionsMs"] = sections;
+
+    QJsonObject counters;
+    for (int i = 0; i < Profiler::CounterCount; ++i) {
+        const Profiler::Counter counter = static_cast<Profiler::Counter>(i);
+        counters[QString::fromLatin1(Profiler::counterName(counter))] = profiler.counter(counter);
+    }
+    result["counters"] = counters;
+    return result;
+}
+
+QJsonObject Benchmark::checkCollisionMasks()
+{
+    // Маски строятся по спрайтам масштаба 1, с ними и сравниваются элементы
+    SpriteCache &cache = SpriteCache::instance();
+    cache.setDevicePixelRatio(1.0);
+    const QVector<CollisionMask> &masks = cache.collisionMasks();
+    const CollisionMask &playerMask = masks.at(SpriteCache::PLAYER);
+    QGraphicsPixmapItem player(cache.playerPixmap());
+
+    const int maxFailures = 20;
+    int offsets = 0;
+    int hits = 0;
+    int mismatches = 0;
+    QJsonArray failures;
+    QVector<const CollisionMask *> others;
+    QVector<QPoint> positions;
+    QVector<quint8> batchHits;
+
+    for (int type = SpriteCache::PLAYER + 1; type < SpriteCache::SpriteCount; ++type) {
+        const CollisionMask &mask = masks.at(type);
+        QGraphicsPixmapItem obstacle(cache.pixmap(type));
+
+        // Смещения с запасом в пиксель: касание краями тоже проверяется
+        for (int dy = -mask.height() - 1; dy <= playerMask.height() + 1; ++dy) {
+            others.resize(0);
+            positions.resize(0);
+            for (int dx = -mask.width() - 1; dx <= playerMask.width() + 1; ++dx) {
+                others.append(&mask);
+                positions.append(QPoint(dx, dy));
+            }
+            batchHits.resize(positions.size());
+            CollisionMask::overlapsBatch(playerMask, QPoint(0, 0), others.constData(),
+                                         positions.constData(), positions.size(), batchHits.data());
+
+            for (int i = 0; i < positions.size(); ++i) {
+                const QPoint &offset = positions[i];
+                obstacle.setPos(offset);
+                const bool items = player.collidesWithItem(&obstacle);
+                const bool pixels = pixelsOverlap(playerMask, mask, offset);
+                const bool packed = CollisionMask::overlaps(playerMask, mask, offset);
+                const bool batch = batchHits[i] != 0;
+                ++offsets;
+                hits += items ? 1 : 0;
+                if (items == pixels && items == packed && items == batch) continue;
+
+                ++mismatches;
+                if (failures.size() < maxFailures) {
+                    QJsonObject failure;
+                    failure["type"] = type;
+                    failure["dx"] = offset.x();
+                    failure["dy"] = offset.y();
+                    failure["collidesWithItem"] = items;
+                    failure["pixels"] = pixels;
+                    failure["overlaps"] = packed;
+                    failure["overlapsBatch"] = batch;
+                    failures.append(failure);
+                }
+            }
+        }
+    }
+
+    QJsonObject result;
+    result["mode"] = QStringLiteral("check-masks");
+    result["offsets"] = offsets;
+    result["hits"] = hits;
+    result["mismatches"] = mismatches;
+    result["failures"] = failures;
+    return result;
+}
+
+bool Benchmark::write(const QJsonObject &report, const QString &path)
+{
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    QFile file;
+    bool opened;
+    if (path.isEmpty()) {
+        opened = file.open(stdout, QIODevice::WriteOnly);
+    } else {
+        file.setFileName(path);
+        opened = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    return opened && file.write(json) == json.size();
+}
@@ -0,0 +1,46 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QJsonObject>
+#include <QString>
+#include "gamesimulation.h"
+#include "profiler.h"
+
+// Параметры нагрузочного прогона
+struct BenchmarkConfig {
+    int ticks = 10000;            // измеряемые такты
+    int warmupTicks = 300;        // такты до начала замеров
+    int obstacles = 0;            // поддерживать не меньше стольких живых препятствий
+    int particles = 0;            // при render: поддерживать не меньше стольких частиц
+    bool render = false;          // рисовать сцену Game каждый такт (платформа offscreen)
+    bool directRender = false;    // при render: прямая отрисовка вместо элементов сцены
+    quint64 seed = 1;
+    DifficultyParams difficulty;
+    WorldParams world;
+    QString outputPath;           // пусто — вывод в stdout
+};
+
+// Нагрузочный прогон игры фиксированной длины без таймеров.
+// Сообщает пропускную способность (тактов в секунду) и перцентили
+// времени спавна, движения, столкновений и отрисовки в JSON,
+// чтобы результаты можно было сравнивать между коммитами.
+class Benchmark
+{
+public:
+    static QJsonObject run(const BenchmarkConfig &config);
+    static bool write(const QJsonObject &report, const QString &path);
+
+    // Сверка узкой фазы: для каждой пары игрок/препятствие и всех смещений,
+    // при которых спрайты хотя бы соседствуют, CollisionMask::overlaps() и
+    // overlapsBatch() сравниваются с QGraphicsItem::collidesWithItem() и
+    // попиксельной проверкой по testPixel(). В отчёте — число расхождений
+    static QJsonObject checkCollisionMasks();
+
+private:
+    static QJsonObject runHeadless(const BenchmarkConfig &config);
+    static QJsonObject runRendered(const BenchmarkConfig &config);
+    static QJsonObject report(const BenchmarkConfig &config, const Profiler &profiler,
+                              double elapsedMs, int finalObstacles);
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,97 @@
+#include "collisiongrid.h"
+#include "obstaclestore.h"
+#include <cmath>
+
+CollisionGrid::CollisionGrid(const QRectF &bounds, float cellSize)
+    : bounds(bounds), cellSize(cellSize)
+{
+    columns = qMax(1, static_cast<int>(std::ceil(bounds.width() / cellSize)));
+    rows = qMax(1, static_cast<int>(std::ceil(bounds.height() / cellSize)));
+    cellStart.resize(columns * rows + 1);
+    cellFill.resize(columns * rows);
+}
+
+int CollisionGrid::column(float x) const
+{
+    // Объекты за пределами сетки попадают в крайние ячейки
+    return qBound(0, static_cast<int>(std::floor((x - bounds.left()) / cellSize)), columns - 1);
+}
+
+int CollisionGrid::row(float y) const
+{
+    return qBound(0, static_cast<int>(std::floor((y - bounds.top()) / cellSize)), rows - 1);
+}
+
+void CollisionGrid::build(const ObstacleStore &store, float itemSize)
+{
+    const int slotCount = store.slotCount();
+    if (stamps.size() < slotCount) {
+        stamps.resize(slotCount);
+    }
+
+    // Проход 1: число элементов в каждой ячейке
+    cellFill.fill(0);
+    int total = 0;
+    for (int slot = 0; slot < slotCount; ++slot) {
+        if (!store.isAlive(slot)) continue;
+        const int c0 = column(store.x(slot));
+        const int c1 = column(store.x(slot) + itemSize);
+        const int r0 = row(store.y(slot));
+        const int r1 = row(store.y(slot) + itemSize);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                ++cellFill[r * columns + c];
+                ++total;
+            }
+        }
+    }
+
+    // Префиксные суммы
+    int offset = 0;
+    for (int cell = 0; cell < cellFill.size(); ++cell) {
+        cellStart[cell] = offset;
+        offset += cellFill[cell];
+        cellFill[cell] = cellStart[cell];
+    }
+    cellStart[cellFill.size()] = offset;
+
+    // Проход 2: раскладка слотов по ячейкам
+    cellItems.resize(total);
+    for (int slot = 0; slot < slotCount; ++slot) {
+        if (!store.isAlive(slot)) continue;
+        const int c0 = column(store.x(slot));
+        const int c1 = column(store.x(slot) + itemSize);
+        const int r0 = row(store.y(slot));
+        const int r1 = row(store.y(slot) + itemSize);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                cellItems[cellFill[r * columns + c]++] = slot;
+            }
+        }
+    }
+}
+
+void CollisionGrid::query(const QRectF &rect, QVector<int> &slots)
+{
+    if (++queryStamp == 0) {
+        stamps.fill(0);
+        queryStamp = 1;
+    }
+
+    const int c0 = column(rect.left());
+    const int c1 = column(rect.right());
+    const int r0 = row(rect.top());
+    const int r1 = row(rect.bottom());
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int cell = r * columns + c;
+            for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                const int slot = cellItems[i];
+                if (stamps[slot] != queryStamp) {
+                    stamps[slot] = queryStamp;
+                    slots.append(slot);
+                }
+            }
+        }
+    }
+}
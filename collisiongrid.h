@@ -0,0 +1,43 @@
+#ifndef COLLISIONGRID_H
+#define COLLISIONGRID_H
+
+#include <QRectF>
+#include <QVector>
+
+class ObstacleStore;
+
+// Равномерная сетка для широкой фазы столкновений.
+// Каждый такт пересобирается по ObstacleStore (сортировка подсчётом по
+// ячейкам), запрос возвращает только препятствия из ячеек, которые
+// пересекает заданный прямоугольник.
+class CollisionGrid
+{
+public:
+    CollisionGrid(const QRectF &bounds, float cellSize);
+
+    // Переносит сетку в новое положение, не меняя её размеров
+    void moveTo(const QPointF &topLeft) { bounds.moveTopLeft(topLeft); }
+
+    // itemSize — сторона квадратного AABB препятствия
+    void build(const ObstacleStore &store, float itemSize);
+
+    // Добавляет в slots (без повторов) препятствия из ячеек под rect
+    void query(const QRectF &rect, QVector<int> &slots);
+
+private:
+    int column(float x) const;
+    int row(float y) const;
+
+    QRectF bounds;
+    float cellSize;
+    int columns;
+    int rows;
+
+    QVector<int> cellStart;   // начало списка ячейки в cellItems (columns * rows + 1)
+    QVector<int> cellItems;   // номера слотов, сгруппированные по ячейкам
+    QVector<int> cellFill;
+    QVector<quint32> stamps;  // метки запроса для отсечения повторов
+    quint32 queryStamp = 0;
+};
+
+#endif // COLLISIONGRID_H
@@ -0,0 +1,119 @@
+#include "collisionmask.h"
+#include <QImage>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// 64 бита строки маски, начиная с бита start (за пределами строки — нули)
+inline quint64 bitsAt(const quint64 *row, int words, int start)
+{
+    const int word = start >= 0 ? start / 64 : -((-start + 63) / 64);
+    const int bit = start - word * 64;
+    const quint64 lo = (word >= 0 && word < words) ? row[word] : 0;
+    if (bit == 0) return lo;
+    const quint64 hi = (word + 1 >= 0 && word + 1 < words) ? row[word + 1] : 0;
+    return (lo >> bit) | (hi << (64 - bit));
+}
+
+// Быстрый путь для масок шириной не больше 64: по одному слову на строку.
+// Строки b сдвигаются на dx (влево при dx >= 0) и складываются с a по AND.
+bool overlapsSingleWord(const quint64 *a, const quint64 *b, int rows, int dx)
+{
+    const bool shiftLeft = dx >= 0;
+    const int shift = shiftLeft ? dx : -dx;
+    if (shift >= 64) return false;
+
+    quint64 acc = 0;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    __m128i vacc = _mm_setzero_si128();
+    for (; i + 2 <= rows; i += 2) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        vb = shiftLeft ? _mm_sll_epi64(vb, count) : _mm_srl_epi64(vb, count);
+        vacc = _mm_or_si128(vacc, _mm_and_si128(va, vb));
+    }
+    alignas(16) quint64 lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), vacc);
+    acc = lanes[0] | lanes[1];
+#endif
+    for (; i < rows; ++i) {
+        acc |= a[i] & (shiftLeft ? b[i] << shift : b[i] >> shift);
+    }
+    return acc != 0;
+}
+}
+
+CollisionMask CollisionMask::fromImage(const QImage &image, int alphaThreshold)
+{
+    CollisionMask mask;
+    if (image.isNull()) return mask;
+
+    const QImage argb = image.convertToFormat(QImage::Format_ARGB32);
+    mask.maskWidth = argb.width();
+    mask.maskHeight = argb.height();
+    mask.rowWords = (mask.maskWidth + 63) / 64;
+    mask.bits.fill(0, mask.rowWords * mask.maskHeight);
+
+    for (int y = 0; y < mask.maskHeight; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(argb.constScanLine(y));
+        quint64 *row = mask.bits.data() + y * mask.rowWords;
+        for (int x = 0; x < mask.maskWidth; ++x) {
+            if (qAlpha(line[x]) >= alphaThreshold) {
+                row[x / 64] |= quint64(1) << (x % 64);
+            }
+        }
+    }
+    return mask;
+}
+
+bool CollisionMask::testPixel(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= maskWidth || y >= maskHeight) return false;
+    return (row(y)[x / 64] >> (x % 64)) & 1;
+}
+
+bool CollisionMask::overlaps(const CollisionMask &a, const CollisionMask &b, const QPoint &offset)
+{
+    if (a.isNull() || b.isNull()) return false;
+
+    const int dx = offset.x();
+    const int dy = offset.y();
+
+    // Пересечение строк в системе координат a
+    const int top = qMax(0, dy);
+    const int bottom = qMin(a.maskHeight, dy + b.maskHeight);
+    if (top >= bottom) return false;
+    if (dx >= a.maskWidth || dx + b.maskWidth <= 0) return false;
+
+    if (a.rowWords == 1 && b.rowWords == 1) {
+        return overlapsSingleWord(a.row(top), b.row(top - dy), bottom - top, dx);
+    }
+
+    for (int y = top; y < bottom; ++y) {
+        const quint64 *aRow = a.row(y);
+        const quint64 *bRow = b.row(y - dy);
+        for (int k = 0; k < a.rowWords; ++k) {
+            if (aRow[k] & bitsAt(bRow, b.rowWords, k * 64 - dx)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int CollisionMask::overlapsBatch(const CollisionMask &subject, const QPoint &subjectPos,
+                                 const CollisionMask *const *others, const QPoint *positions,
+                                 int count, quint8 *hits)
+{
+    int hitCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const bool hit = overlaps(subject, *others[i], positions[i] - subjectPos);
+        hits[i] = hit ? 1 : 0;
+        hitCount += hit;
+    }
+    return hitCount;
+}
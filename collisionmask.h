@@ -0,0 +1,45 @@
+#ifndef COLLISIONMASK_H
+#define COLLISIONMASK_H
+
+#include <QPoint>
+#include <QVector>
+
+class QImage;
+
+// Упакованная битовая маска непрозрачных пикселей спрайта.
+// Каждая строка — wordsPerRow слов по 64 бита, бит i слова k соответствует
+// пикселю x = 64 * k + i. Пиксель считается непрозрачным при alpha >= 128,
+// как в QPixmap::mask(), по которой QGraphicsPixmapItem строит свою форму.
+class CollisionMask
+{
+public:
+    CollisionMask() = default;
+
+    static CollisionMask fromImage(const QImage &image, int alphaThreshold = 128);
+
+    int width() const { return maskWidth; }
+    int height() const { return maskHeight; }
+    int wordsPerRow() const { return rowWords; }
+    bool isNull() const { return bits.isEmpty(); }
+    const quint64 *row(int y) const { return bits.constData() + y * rowWords; }
+    bool testPixel(int x, int y) const;
+
+    // Пересекаются ли непрозрачные пиксели масок a и b,
+    // если левый верхний угол b находится в точке offset относительно a
+    static bool overlaps(const CollisionMask &a, const CollisionMask &b, const QPoint &offset);
+
+    // Пакетная проверка одной маски против count кандидатов.
+    // hits[i] = 1, если subject в точке subjectPos пересекает others[i] в positions[i].
+    // Возвращает число попаданий.
+    static int overlapsBatch(const CollisionMask &subject, const QPoint &subjectPos,
+                             const CollisionMask *const *others, const QPoint *positions,
+                             int count, quint8 *hits);
+
+private:
+    int maskWidth = 0;
+    int maskHeight = 0;
+    int rowWords = 0;
+    QVector<quint64> bits;
+};
+
+#endif // COLLISIONMASK_H
@@ -0,0 +1,209 @@
+#include "difficultytuner.h"
+#include "autopilot.h"
+#include "spritecache.h"
+#include "workstealingpool.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <algorithm>
+
+namespace {
+// Сводка распределения: среднее и перцентили
+QJsonObject distributionJson(QVector<double> values)
+{
+    QJsonObject object;
+    if (values.isEmpty()) return object;
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    const auto at = [&values](double fraction) {
+        return values[qMin(values.size() - 1, static_cast<int>(fraction * values.size()))];
+    };
+    object["mean"] = sum / values.size();
+    object["min"] = values.first();
+    object["p10"] = at(0.10);
+    object["p50"] = at(0.50);
+    object["p90"] = at(0.90);
+    object["max"] = values.last();
+    return object;
+}
+}
+
+bool DifficultyTuner::parsePolicy(const QString &name, TunerConfig::Policy &policy)
+{
+    if (name == QLatin1String("scripted")) {
+        policy = TunerConfig::Scripted;
+    } else if (name == QLatin1String("random")) {
+        policy = TunerConfig::Random;
+    } else if (name == QLatin1String("autopilot")) {
+        policy = TunerConfig::Bot;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *DifficultyTuner::policyName(TunerConfig::Policy policy)
+{
+    switch (policy) {
+    case TunerConfig::Scripted: return "scripted";
+    case TunerConfig::Random: return "random";
+    case TunerConfig::Bot: return "autopilot";
+    }
+    return "";
+}
+
+TunerRun DifficultyTuner::playSession(const DifficultyParams &params, const QVector<CollisionMask> &masks,
+                                      TunerConfig::Policy policy, quint64 seed, int maxTicks)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    GameSimulation simulation;
+    simulation.setCollisionMasks(masks);
+    simulation.setDifficultyParams(params);
+    simulation.reset(seed);
+
+    // Генератор игрока отделён от генератора симуляции
+    GameRng playerRng(seed ^ 0x9e3779b97f4a7c15ULL);
+    int direction = 0;
+    int holdTicks = 0;
+
+    // Сессии и так выполняются параллельно, бот считает в своём потоке
+    std::unique_ptr<Autopilot> bot;
+    if (policy == TunerConfig::Bot) {
+        AutopilotConfig botConfig;
+        botConfig.threads = 1;
+        bot.reset(new Autopilot(botConfig));
+    }
+
+    TunerRun result;
+    while (!simulation.isGameOver() && static_cast<int>(result.ticks) < maxTicks) {
+        SimInput input;
+        if (policy == TunerConfig::Scripted) {
+            input.direction = (result.ticks / 60) % 3 - 1;
+        } else if (bot) {
+            input.direction = bot->decide(simulation);
+        } else {
+            if (holdTicks <= 0) {
+                direction = playerRng.bounded(-1, 2);
+                holdTicks = playerRng.bounded(10, 60);
+            }
+            --holdTicks;
+            input.direction = direction;
+        }
+        simulation.step(GameSimulation::TickMs, input);
+        ++result.ticks;
+    }
+
+    result.score = simulation.getScore();
+    result.gameOver = simulation.isGameOver();
+    result.elapsedNs = timer.nsecsElapsed();
+    return result;
+}
+
+QJsonObject DifficultyTuner::run(const TunerConfig &config)
+{
+    // Сетка параметров
+    QVector<DifficultyParams> points;
+    for (double speedStep : config.speedFactorSteps) {
+        for (double intervalFactor : config.spawnIntervalFactors) {
+            for (int maxSpawn : config.maxSpawnCounts) {
+                for (int minInterval : config.minSpawnIntervalsMs) {
+                    for (int period : config.periodsMs) {
+                        DifficultyParams params;
+                        params.speedFactorStep = speedStep;
+                        params.spawnIntervalFactor = intervalFactor;
+                        params.maxSpawnCount = maxSpawn;
+                        params.minSpawnIntervalMs = minInterval;
+                        params.periodMs = period;
+                        points.append(params);
+                    }
+                }
+            }
+        }
+    }
+
+    const int runs = qMax(1, config.runs);
+    // Маски строятся до запуска потоков: SpriteCache не потокобезопасен
+    const QVector<CollisionMask> masks = SpriteCache::instance().collisionMasks();
+
+    // Каждая задача пишет только в свою ячейку, синхронизация не нужна
+    QVector<TunerRun> results(points.size() * runs);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    quint64 steals = 0;
+    int threadCount = 0;
+    {
+        WorkStealingPool pool(config.threads);
+        threadCount = pool.threadCount();
+        TunerRun *out = results.data();
+        const TunerConfig::Policy policy = config.policy;
+        const int maxTicks = config.maxTicks;
+        for (int point = 0; point < points.size(); ++point) {
+            const DifficultyParams params = points[point];
+            for (int run = 0; run < runs; ++run) {
+                TunerRun *slot = out + point * runs + run;
+                const quint64 seed = config.seed + static_cast<quint64>(run);
+                pool.submit([slot, params, seed, policy, maxTicks, &masks] {
+                    *slot = playSession(params, masks, policy, seed, maxTicks);
+                });
+            }
+        }
+        pool.waitForAll();
+        steals = pool.steals();
+    }
+    const double elapsedMs = elapsed.nsecsElapsed() / 1e6;
+
+    // Сводка по точкам
+    QJsonArray pointsJson;
+    quint64 totalTicks = 0;
+    for (int point = 0; point < points.size(); ++point) {
+        const DifficultyParams &params = points[point];
+        QVector<double> survivalSec;
+        QVector<double> scores;
+        QVector<double> ticksPerSecond;
+        int gameOvers = 0;
+        for (int run = 0; run < runs; ++run) {
+            const TunerRun &result = results[point * runs + run];
+            survivalSec.append(result.ticks * GameSimulation::TickMs / 1000.0);
+            scores.append(result.score);
+            if (result.elapsedNs > 0) {
+                ticksPerSecond.append(result.ticks * 1e9 / result.elapsedNs);
+            }
+            gameOvers += result.gameOver ? 1 : 0;
+            totalTicks += result.ticks;
+        }
+
+        QJsonObject paramsJson;
+        paramsJson["speedFactorStep"] = params.speedFactorStep;
+        paramsJson["spawnIntervalFactor"] = params.spawnIntervalFactor;
+        paramsJson["maxSpawnCount"] = params.maxSpawnCount;
+        paramsJson["minSpawnIntervalMs"] = params.minSpawnIntervalMs;
+        paramsJson["periodMs"] = params.periodMs;
+
+        QJsonObject pointJson;
+        pointJson["params"] = paramsJson;
+        pointJson["gameOverRate"] = static_cast<double>(gameOvers) / runs;
+        pointJson["survivalSec"] = distributionJson(survivalSec);
+        pointJson["score"] = distributionJson(scores);
+        pointJson["ticksPerSecondPerSim"] = distributionJson(ticksPerSecond);
+        pointsJson.append(pointJson);
+    }
+
+    QJsonObject result;
+    result["mode"] = QStringLiteral("tune");
+    result["policy"] = QString::fromLatin1(policyName(config.policy));
+    result["runsPerPoint"] = runs;
+    result["maxTicks"] = config.maxTicks;
+    result["seed"] = QString::number(config.seed);
+    result["threads"] = threadCount;
+    result["sessions"] = points.size() * runs;
+    result["steals"] = static_cast<double>(steals);
+    result["elapsedMs"] = elapsedMs;
+    result["ticksPerSecond"] = elapsedMs > 0.0 ? totalTicks * 1000.0 / elapsedMs : 0.0;
+    result["points"] = pointsJson;
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef DIFFICULTYTUNER_H
+#define DIFFICULTYTUNER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include "gamesimulation.h"
+
+// Параметры перебора кривой сложности. Каждая точка сетки — сочетание
+// значений из списков; для каждой точки играется runs сессий.
+struct TunerConfig {
+    enum Policy {
+        Scripted,   // как в --bench: влево, на месте, вправо по 60 тактов
+        Random,     // случайное направление на случайное время
+        Bot         // Autopilot с поиском вперёд (эталонный игрок, долгие прогоны)
+    };
+
+    int runs = 200;                   // сессий на точку сетки
+    int maxTicks = 60 * 60 * 10;      // предел длины сессии (10 минут игры)
+    Policy policy = Random;
+    quint64 seed = 1;
+    int threads = 0;                  // 0 — по числу ядер
+    QString outputPath;               // пусто — вывод в stdout
+
+    QVector<double> speedFactorSteps{1.10, 1.15, 1.20};
+    QVector<double> spawnIntervalFactors{0.85, 0.90, 0.95};
+    QVector<int> maxSpawnCounts{5};
+    QVector<int> minSpawnIntervalsMs{150};
+    QVector<int> periodsMs{20000};
+};
+
+// Итог одной сессии
+struct TunerRun {
+    quint32 ticks = 0;
+    int score = 0;
+    bool gameOver = false;
+    qint64 elapsedNs = 0;
+};
+
+// Пакетный подбор констант сложности методом Монте-Карло.
+// Тысячи сессий GameSimulation без отображения выполняются на всех
+// ядрах пулом с перехватом работы; по каждой точке сетки выводятся
+// распределения времени жизни и счёта и скорость симуляции в JSON.
+// Номера seed сессий одинаковы для всех точек, поэтому точки
+// сравниваются на одних и тех же последовательностях спавна.
+class DifficultyTuner
+{
+public:
+    static QJsonObject run(const TunerConfig &config);
+
+    // Одна сессия до конца игры или maxTicks
+    static TunerRun playSession(const DifficultyParams &params, const QVector<CollisionMask> &masks,
+                                TunerConfig::Policy policy, quint64 seed, int maxTicks);
+
+    static bool parsePolicy(const QString &name, TunerConfig::Policy &policy);
+    static const char *policyName(TunerConfig::Policy policy);
+};
+
+#endif // DIFFICULTYTUNER_H
@@ -0,0 +1,27 @@
+#include "framesnapshot.h"
+
+void FrameSnapshot::capture(const GameSimulation &simulation)
+{
+    timeMs = simulation.getTimeMs();
+    playerX = simulation.getPlayerX();
+    previousPlayerX = simulation.getPreviousPlayerX();
+    playerY = simulation.getPlayerY();
+    score = simulation.getScore();
+    lives = simulation.getLives();
+    gameOver = simulation.isGameOver();
+    collisions = simulation.getCollisionStats();
+
+    const ObstacleStore &store = simulation.getObstacles();
+    slotCount = store.slotCount();
+    obstacles.resize(0);
+    for (int slot = 0; slot < slotCount; ++slot) {
+        if (!store.isAlive(slot)) continue;
+        ObstacleState state;
+        state.slot = slot;
+        state.type = store.type(slot);
+        state.x = store.x(slot);
+        state.y = store.y(slot);
+        state.previousY = store.previousY(slot);
+        obstacles.append(state);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef FRAMESNAPSHOT_H
+#define FRAMESNAPSHOT_H
+
+#include <QVector>
+#include "autopilot.h"
+#include "gamesimulation.h"
+
+// Неизменяемый для читателя снимок состояния симуляции, по которому
+// рисуется кадр: позиции на двух последних шагах (для интерполяции),
+// счёт и жизни. Буферы переиспользуются между захватами.
+struct FrameSnapshot {
+    struct ObstacleState {
+        int slot;
+        int type;
+        float x;
+        float y;
+        float previousY;
+    };
+
+    quint32 session = 0;        // номер сессии Game; снимки прошлых сессий отбрасываются
+    quint32 tick = 0;           // число выполненных шагов
+    qint64 stepNs = 0;          // момент последнего шага по часам издателя
+    qint64 stepCostNs = 0;      // длительность последнего шага
+    quint32 inputSequence = 0;  // последняя команда ввода, применённая до шагов снимка
+    quint32 restoreSequence = 0; // последний обработанный запрос перемотки или загрузки
+    AutopilotStats autopilot;   // последнее решение бота; нули, если он выключен
+    double timeMs = 0.0;
+    double playerX = 0.0;
+    double previousPlayerX = 0.0;
+    double playerY = 0.0;
+    int score = 0;
+    int lives = 0;
+    bool gameOver = false;
+    int slotCount = 0;
+    CollisionStats collisions;
+    QVector<ObstacleState> obstacles; // живые препятствия по возрастанию слота
+
+    void capture(const GameSimulation &simulation);
+
+    double interpolatedPlayerX(double alpha) const
+    {
+        return previousPlayerX + (playerX - previousPlayerX) * alpha;
+    }
+    static float interpolatedY(const ObstacleState &state, float alpha)
+    {
+        return state.previousY + (state.y - state.previousY) * alpha;
+    }
+};
+
+#endif // FRAMESNAPSHOT_H
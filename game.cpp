@@ -1,146 +1,497 @@
 #include "game.h"
 #include "obstacle.h"
+#include "spritecache.h"
+#include "trace.h"
+#include <QDateTime>
 #include <QFont>
 #include <QBrush>
 #include <QImage>
-#include <QRandomGenerator>
 #include <QGraphicsTextItem>
 #include <QKeyEvent>
 #include <QPainter>
 #include <QLinearGradient>
 #include <QDebug>
-#include <cmath>
+#include <QRandomGenerator>
+
+static_assert(Obstacle::STAR == GameSimulation::Star && Obstacle::HEART == GameSimulation::Heart,
+              "Obstacle::ObstacleType и GameSimulation::ObstacleKind должны совпадать");
 
 Game::Game(QWidget *parent) : QGraphicsView(parent)
 {
     scene = new QGraphicsScene(this);
-    scene->setSceneRect(0, 0, 800, 600);
     setScene(scene);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    setFixedSize(800, 600);
+    // Окно всегда размером в экран; мир может быть больше
+    setFixedSize(GameSimulation::FieldWidth, GameSimulation::FieldHeight);
 
     setFocusPolicy(Qt::StrongFocus);
     setFocus();
+    inputClock.start();
 
-    QPixmap bg(800, 600);
-    QPainter painter(&bg);
-    QLinearGradient gradient(0, 0, 0, 600);
-    gradient.setColorAt(0, QColor(135, 206, 235));
-    gradient.setColorAt(1, QColor(255, 255, 255));
-    painter.fillRect(0, 0, 800, 600, gradient);
-    scene->setBackgroundBrush(bg);
+    // Спрайты в масштабе экрана окна; если main() не подготовил его
+    // заранее, набор растеризуется здесь
+    SpriteCache::instance().setDevicePixelRatio(devicePixelRatioF());
+
+    // Симуляция проверяет столкновения по маскам тех же спрайтов, что рисуются
+    simulation.setCollisionMasks(SpriteCache::instance().collisionMasks());
+
+    simulation.reset(QRandomGenerator::global()->generate64());
+    simulation.setProfiler(&profiler);
+
+    // Пул препятствий: прогрев до старта, чтобы игровой цикл не выделял память
+    obstaclePool = new ObstaclePool(scene, 512, this);
+    obstaclePool->prewarm(128);
+    obstacleSprites.reserve(512);
 
     // Игрок
     player = new Player();
-    player->setPos(370, 500);
-    player->setFlag(QGraphicsItem::ItemIsFocusable);
+    player->setPos(simulation.getPlayerX(), simulation.getPlayerY());
     scene->addItem(player);
 
-    // Счёт/жизни
-    score = 0;
-    scoreText = new QGraphicsTextItem("Очки: 0");
-    scoreText->setDefaultTextColor(Qt::blue);
-    scoreText->setFont(QFont("Arial", 16, QFont::Bold));
-    scoreText->setPos(10, 10);
-    scene->addItem(scoreText);
-
-    livesText = new QGraphicsTextItem("Жизни: 3");
-    livesText->setDefaultTextColor(Qt::green);
-    livesText->setFont(QFont("Arial", 16, QFont::Bold));
-    livesText->setPos(10, 40);
-    scene->addItem(livesText);
-
-    // Таймеры
-    gameTimer = new QTimer(this);
-    connect(gameTimer, &QTimer::timeout, this, &Game::checkCollisions);
+    // Все частицы эффектов — один элемент сцены
+    particleItem = new ParticleItem(&particles);
+    scene->addItem(particleItem);
 
-    spawnTimer = new QTimer(this);
-    connect(spawnTimer, &QTimer::timeout, this, &Game::spawnObstacle);
+    // HUD и надписи не рисуют ничего сами по себе: они дети слоя экрана,
+    // который переносится вместе с камерой
+    screenLayer = new QGraphicsRectItem();
+    screenLayer->setFlag(QGraphicsItem::ItemHasNoContents);
+    screenLayer->setZValue(90);
+    scene->addItem(screenLayer);
 
-    difficultyTimer = new QTimer(this);
-    connect(difficultyTimer, &QTimer::timeout, this, &Game::increaseDifficulty);
+    // Счёт/жизни: перерисовываются не чаще раза за кадр
+    hud = new HudItem(screenLayer);
+    hud->setPos(10, 10);
 
-    playerMoveTimer = new QTimer(this);
-    connect(playerMoveTimer, &QTimer::timeout, this, &Game::movePlayer);
+    // Оверлей профилировщика, переключается клавишей F3
+    statsText = new QGraphicsTextItem(screenLayer);
+    statsText->setDefaultTextColor(QColor(40, 40, 40));
+    statsText->setFont(QFont("Courier New", 9));
+    statsText->setPos(10, 70);
+    statsText->setZValue(100);
+    statsText->setVisible(false);
+
+    // Надпись конца игры создаётся один раз и только показывается/скрывается
+    gameOverText = new QGraphicsTextItem("ИГРА ОКОНЧЕНА!\nНажмите R для рестарта\nBackspace — перемотка", screenLayer);
+    gameOverText->setDefaultTextColor(Qt::red);
+    gameOverText->setFont(QFont("Arial", 24, QFont::Bold));
+    gameOverText->setPos(250, 250);
+    gameOverText->setZValue(95);
+    gameOverText->setVisible(false);
+
+    pauseText = new QGraphicsTextItem("ПАУЗА\nP — продолжить", screenLayer);
+    pauseText->setDefaultTextColor(QColor(40, 40, 40));
+    pauseText->setFont(QFont("Arial", 24, QFont::Bold));
+    pauseText->setPos(300, 250);
+    pauseText->setZValue(95);
+    pauseText->setVisible(false);
+
+    captureFrame();
+    resizeScene();
+
+    // Таймер
+    gameTimer = new QTimer(this);
+    gameTimer->setTimerType(Qt::PreciseTimer);
+    connect(gameTimer, &QTimer::timeout, this, &Game::onFrameTimer);
 
     startGame();
 }
 
+Game::~Game()
+{
+    if (worker) {
+        worker->shutdown();
+    }
+    saveRecording();
+}
+
 void Game::startGame()
 {
-    gameTimer->start(16);
-    spawnTimer->start(spawnIntervalMs);
-    difficultyTimer->start(20000);
-    playerMoveTimer->start(16);
+    if (isPaused()) {
+        // Игра пойдёт, когда снимут паузу
+        resumeAfterPause = true;
+        pauseText->show();
+        return;
+    }
+
+    // Отсчёт времени начинается заново, чтобы после паузы не было скачка
+    accumulatorMs = 0.0;
+    lastFrameNs = 0;
+    frameClock.start();
+    gameTimer->start(renderIntervalMs);
+    postToWorker(WorkerCommand::Start);
+}
+
+void Game::setThreadedSimulation(bool enabled)
+{
+    if (enabled == (worker != nullptr)) return;
+
+    const bool wasRunning = gameTimer->isActive() || resumeAfterPause;
+    stopGame();
+    if (enabled) {
+        startWorker();
+    } else {
+        stopWorker();
+    }
+
+    // Сессия начинается заново на выбранном пути
+    resetSession(simulation.getSeed());
+    if (wasRunning) {
+        startGame();
+    }
+}
+
+void Game::startWorker()
+{
+    // Поток получает копию настроенной симуляции (маски, сложность, мир)
+    worker = new SimulationWorker(simulation, this);
+    worker->start();
+    postToWorker(WorkerCommand::SetAutopilot, autopilotEnabled ? 1 : 0);
+}
+
+void Game::stopWorker()
+{
+    worker->shutdown();
+    delete worker;
+    worker = nullptr;
+}
+
+void Game::setWorldParams(const WorldParams &params)
+{
+    const bool wasRunning = gameTimer->isActive() || resumeAfterPause;
+    stopGame();
+    simulation.setWorldParams(params);
+    if (worker) {
+        // Копия симуляции в потоке настраивается только при создании
+        stopWorker();
+        startWorker();
+    }
+    resizeScene();
+
+    resetSession(simulation.getSeed());
+    if (wasRunning) {
+        startGame();
+    }
+}
+
+void Game::resizeScene()
+{
+    const WorldParams &world = simulation.getWorldParams();
+    scene->setSceneRect(0, 0, world.width, GameSimulation::FieldHeight);
+
+    // Фон — одна плитка размером с экран; кисть сцены и drawTiledPixmap()
+    // повторяют её по горизонтали
+    background = QPixmap(GameSimulation::FieldWidth, GameSimulation::FieldHeight);
+    QPainter painter(&background);
+    QLinearGradient gradient(0, 0, 0, GameSimulation::FieldHeight);
+    gradient.setColorAt(0, QColor(135, 206, 235));
+    gradient.setColorAt(1, QColor(255, 255, 255));
+    painter.fillRect(background.rect(), gradient);
+    painter.end();
+    if (renderBackend == SceneBackend) {
+        scene->setBackgroundBrush(background);
+    }
+
+    particleItem->setBounds(scene->sceneRect());
+    camera = QRectF();
+    updateCamera();
+}
+
+void Game::updateCamera()
+{
+    const WorldParams &world = simulation.getWorldParams();
+    const double playerCenter = currentFrame->interpolatedPlayerX(renderAlpha) + GameSimulation::PlayerSize / 2.0;
+    // Целые координаты: при дробных фон и спрайты размывались бы при прокрутке
+    const int left = qBound(0, qRound(playerCenter - GameSimulation::FieldWidth / 2.0),
+                            world.width - GameSimulation::FieldWidth);
+    const QRectF view(left, 0, GameSimulation::FieldWidth, GameSimulation::FieldHeight);
+    if (view == camera) return;
+
+    camera = view;
+    setSceneRect(camera);
+    screenLayer->setPos(camera.topLeft());
+}
+
+void Game::postToWorker(WorkerCommand::Type type, quint64 value, quint32 sequence)
+{
+    if (!worker) return;
+    WorkerCommand command;
+    command.type = type;
+    command.session = session;
+    command.sequence = sequence;
+    command.value = value;
+    worker->post(command);
+}
+
+bool Game::isGameOver() const
+{
+    return worker ? currentFrame->gameOver : simulation.isGameOver();
+}
+
+int Game::getObjectCount() const
+{
+    return worker ? currentFrame->obstacles.size() : simulation.getObstacles().aliveCount();
+}
+
+void Game::setRenderIntervalMs(int intervalMs)
+{
+    renderIntervalMs = qMax(1, intervalMs);
+    if (gameTimer->isActive()) {
+        gameTimer->start(renderIntervalMs);
+    }
+}
+
+void Game::setRenderBackend(RenderBackend backend)
+{
+    if (backend == renderBackend) return;
+    renderBackend = backend;
+
+    if (renderBackend == DirectBackend) {
+        // Препятствия и игрок рисуются в drawBackground(); в сцене
+        // остаются только HUD и надписи
+        releaseAllSprites();
+        player->hide();
+        scene->setBackgroundBrush(Qt::NoBrush);
+    } else {
+        // Спрайты будут взяты из пула по текущему снимку
+        player->show();
+        scene->setBackgroundBrush(background);
+    }
+    syncSprites();
 }
 
 void Game::stopGame()
 {
+    // Кадров с результатом ожидающих команд уже не будет
+    input.clearAwaiting();
+    resumeAfterPause = false;
+    pauseText->hide();
     gameTimer->stop();
-    spawnTimer->stop();
-    difficultyTimer->stop();
-    playerMoveTimer->stop();
+    postToWorker(WorkerCommand::Stop);
+}
+
+void Game::setPaused(PauseReason reason, bool paused)
+{
+    const bool wasPaused = isPaused();
+    pauseReasons = paused ? (pauseReasons | reason) : (pauseReasons & ~reason);
+    if (wasPaused == isPaused()) return;
 
-    for (Obstacle *obstacle : obstacles) {
-        if (obstacle) {
-            obstacle->stopFalling();
+    if (isPaused()) {
+        // Окончившаяся или остановленная игра после паузы не запускается
+        const bool wasRunning = gameTimer->isActive();
+        stopGame();
+        resumeAfterPause = wasRunning;
+        pauseText->setVisible(wasRunning);
+    } else {
+        pauseText->hide();
+        if (resumeAfterPause) {
+            // startGame() начинает отсчёт кадров заново: накопитель шагов
+            // пуст, поэтому время паузы не догоняется
+            resumeAfterPause = false;
+            startGame();
         }
     }
 }
 
+void Game::hideEvent(QHideEvent *event)
+{
+    QGraphicsView::hideEvent(event);
+    setPaused(WindowHidden, true);
+}
+
+void Game::changeEvent(QEvent *event)
+{
+    QGraphicsView::changeEvent(event);
+
+    if (event->type() == QEvent::WindowStateChange) {
+        setPaused(WindowMinimized, window()->isMinimized());
+    } else if (event->type() == QEvent::ActivationChange) {
+        const bool inactive = !isActiveWindow();
+        if (inactive && !autopilotEnabled && !replaying) {
+            // Отпускание клавиш в неактивное окно не придёт. Отпускается каждая
+            // зажатая клавиша: при обеих зажатых направление может быть 0.
+            // Команды, ещё ждущие шага, применяются сейчас (номер шага тот же),
+            // иначе нажатие из очереди осталось бы без отпускания
+            applyQueuedInput();
+            for (int key : { Qt::Key_Left, Qt::Key_Right }) {
+                if (keys.isPressed(key)) {
+                    queueInput(InputEvent::KeyRelease, key);
+                }
+            }
+        }
+        setPaused(WindowInactive, inactive);
+    }
+}
+
 void Game::resetGame()
 {
+    resetSession(QRandomGenerator::global()->generate64());
+}
+
+void Game::resetSession(quint64 seed)
+{
+    if (!recordingPath.isEmpty()) {
+        recording.append(tickIndex, InputEvent::Reset, seed);
+    }
+
     stopGame();
-    removeAllObjects();
 
+    // Снимки и события прежней сессии из потока симуляции отбрасываются
+    ++session;
+    postToWorker(WorkerCommand::Reset, seed);
+
+    // Пока не пришёл первый снимок новой сессии, кадр строится по локальной копии.
+    // Элементы сцены не пересоздаются: спрайты сверяются с новым снимком
+    // Клавиши сбрасываются, как и в потоке симуляции и в replay(): иначе
+    // зажатая до сброса клавиша вела бы игрока только в одном из режимов
+    simulation.reset(seed);
+    keys = KeyDirection();
+    history.clear();
+    quickSaveState.clear();
+    particles.clear();
+    particleItem->sync();
+    captureFrame();
+    updateCamera();
+    syncSprites();
+    hideGameOver();
     player->reset();
-    score = 0;
-    scoreText->setPlainText("Очки: 0");
-    livesText->setPlainText("Жизни: 3");
-    livesText->setDefaultTextColor(Qt::green);
-
-    obstacleSpeedFactor = 1.0;
-    spawnIntervalMs = 800;
-    spawnCount = 1;
-
-    // Удаляем текст Game Over
-    QList<QGraphicsItem*> items = scene->items();
-    for (QGraphicsItem *item : items) {
-        QGraphicsTextItem *textItem = dynamic_cast<QGraphicsTextItem*>(item);
-        if (textItem && textItem != scoreText && textItem != livesText) {
-            scene->removeItem(item);
-            delete textItem;
+    hud->setScore(simulation.getScore());
+    hud->setLives(simulation.getLives());
+    hud->flush();
+}
+
+void Game::rewind(quint32 ticksBack)
+{
+    if (!canRestore()) return;
+
+    if (worker) {
+        postToWorker(WorkerCommand::Rewind, ticksBack, ++restoreRequest);
+        particles.clear();
+        particleItem->sync();
+        // Кадры нужны, чтобы дождаться ответа потока: pollWorker() уберёт
+        // надпись или, если перематывать некуда, снова остановит игру
+        if (gameOverShown) {
+            startGame();
         }
+        return;
+    }
+
+    quint32 restoredTick = 0;
+    if (history.rewind(ticksBack, tickIndex, simulation, restoredTick)) {
+        Trace::instant(Trace::Rewind, static_cast<qint32>(ticksBack));
+        afterRestore(restoredTick);
     }
 }
 
-void Game::spawnObject(int type)
+void Game::quickSave()
+{
+    if (!canRestore()) return;
+
+    if (worker) {
+        postToWorker(WorkerCommand::SaveState);
+        return;
+    }
+    simulation.saveState(quickSaveState);
+    quickSaveTick = tickIndex;
+}
+
+void Game::quickLoad()
 {
-    int randomX = QRandomGenerator::global()->bounded(20, 760);
-    Obstacle::ObstacleType obstacleType = static_cast<Obstacle::ObstacleType>(type);
+    if (!canRestore()) return;
+
+    if (worker) {
+        postToWorker(WorkerCommand::LoadState, 0, ++restoreRequest);
+        particles.clear();
+        particleItem->sync();
+        if (gameOverShown) {
+            startGame();
+        }
+        return;
+    }
+
+    if (quickSaveState.isEmpty() || !simulation.restoreState(quickSaveState)) return;
+    // Снимки кольца относятся к другой ветке событий
+    history.clear();
+    afterRestore(quickSaveTick);
+}
 
-    Obstacle *obstacle = new Obstacle(obstacleType);
-    obstacle->setPos(randomX, -50 - QRandomGenerator::global()->bounded(0,200));
-    scene->addItem(obstacle);
-    obstacles.append(obstacle);
+void Game::afterRestore(quint32 restoredTick)
+{
+    tickIndex = restoredTick;
+    accumulatorMs = 0.0;
+    renderAlpha = 1.0;
+    // Частицы остались от событий, которых после восстановления ещё не было
+    particles.clear();
+    particleItem->sync();
+    captureFrame();
+    updateCamera();
+    syncSprites();
+    hud->setScore(simulation.getScore());
+    hud->setLives(simulation.getLives());
+    hud->flush();
 
-    if (obstacleSpeedFactor != 1.0) {
-        obstacle->multiplySpeed(obstacleSpeedFactor);
+    if (gameOverShown && !simulation.isGameOver()) {
+        hideGameOver();
+        startGame();
     }
+}
 
-    obstacle->startFalling();
-    connect(obstacle, &Obstacle::obstacleMissed, this, &Game::handleObstacleMissed);
+void Game::spawnObject(int type)
+{
+    if (worker) {
+        postToWorker(WorkerCommand::Spawn, static_cast<quint64>(type));
+        return;
+    }
+    simulation.clearEvents();
+    simulation.spawnObject(type);
+    applySimulationEvents();
+    captureFrame();
+    syncSprites();
 }
 
 void Game::removeAllObjects()
 {
-    for (Obstacle *obstacle : obstacles) {
-        if (obstacle) {
-            obstacle->safeRemove();
-        }
+    releaseAllSprites();
+    simulation.removeAllObjects();
+    postToWorker(WorkerCommand::RemoveAll);
+    captureFrame();
+}
+
+void Game::startRecording(const QString &path)
+{
+    // Номера шагов в записи ведёт только однопоточный путь
+    setThreadedSimulation(false);
+    // Прежняя запись сохраняется. Сессия сбрасывается до начала новой
+    // записи: её seed уже в заголовке, событие Reset на шаге 0 не нужно
+    saveRecording();
+    recordingPath.clear();
+    resetSession(simulation.getSeed());
+    recordingPath = path;
+    tickIndex = 0;
+    recording.start(simulation.getSeed());
+    startGame();
+}
+
+void Game::startReplay(const InputRecording &log)
+{
+    setThreadedSimulation(false);
+    recordingPath.clear();
+    replaying = true;
+    replayEnded = false;
+    replayLog = log;
+    replayCursor = 0;
+    tickIndex = 0;
+    resetSession(log.getSeed());
+    startGame();
+}
+
+void Game::saveRecording()
+{
+    if (recordingPath.isEmpty()) return;
+    if (!recording.save(recordingPath, tickIndex)) {
+        qWarning() << "Не удалось сохранить запись в" << recordingPath;
     }
-    obstacles.clear();
 }
 
 void Game::keyPressEvent(QKeyEvent *event)
@@ -149,10 +500,29 @@ void Game::keyPressEvent(QKeyEvent *event)
         return;
     }
 
-    if (event->key() == Qt::Key_Left) {
-        playerDirection = -1;
-    } else if (event->key() == Qt::Key_Right) {
-        playerDirection = 1;
+    if (event->key() == Qt::Key_F3) {
+        statsText->setVisible(!statsText->isVisible());
+        updateStatsOverlay();
+    } else if (event->key() == Qt::Key_F2) {
+        dumpTrace();
+    } else if (event->key() == Qt::Key_P || event->key() == Qt::Key_Pause) {
+        setPaused(UserPause, !(pauseReasons & UserPause));
+    } else if (replaying) {
+        // При воспроизведении игровой ввод берётся только из записи
+        return;
+    } else if (event->key() == Qt::Key_Left || event->key() == Qt::Key_Right) {
+        // При автопилоте стрелки не мешают боту
+        if (!autopilotEnabled) {
+            queueInput(InputEvent::KeyPress, event->key());
+        }
+    } else if (event->key() == Qt::Key_A) {
+        setAutopilot(!autopilotEnabled);
+    } else if (event->key() == Qt::Key_Backspace) {
+        rewind();
+    } else if (event->key() == Qt::Key_F5) {
+        quickSave();
+    } else if (event->key() == Qt::Key_F9) {
+        quickLoad();
     } else if (event->key() == Qt::Key_R) {
         resetGame();
         startGame();
@@ -163,135 +533,494 @@ void Game::keyPressEvent(QKeyEvent *event)
 
 void Game::keyReleaseEvent(QKeyEvent *event)
 {
-    if (event->isAutoRepeat()) return;
+    if (event->isAutoRepeat() || replaying) return;
 
-    if (event->key() == Qt::Key_Left && playerDirection == -1) {
-        playerDirection = 0;
-    } else if (event->key() == Qt::Key_Right && playerDirection == 1) {
-        playerDirection = 0;
+    if ((event->key() == Qt::Key_Left || event->key() == Qt::Key_Right) && !autopilotEnabled) {
+        queueInput(InputEvent::KeyRelease, event->key());
     }
 
     QGraphicsView::keyReleaseEvent(event);
 }
 
-void Game::movePlayer()
+void Game::queueInput(InputEvent::Type type, int key)
 {
-    if (!player) return;
-    if (playerDirection == 0) return;
-
-    qreal step = static_cast<qreal>(playerSpeed);
-    qreal newX = player->x() + (playerDirection == -1 ? -step : step);
-    newX = qBound(0.0, newX, 740.0);
-    player->setPos(newX, player->y());
+    // Пока игра стоит (пауза, конец игры), кадра с результатом команды нет
+    input.push(type, key, inputClock.nsecsElapsed(), gameTimer->isActive());
+    if (worker) {
+        // Очередь команд потока симуляции тоже разбирается перед шагом
+        applyQueuedInput();
+    }
 }
 
-void Game::spawnObstacle()
+void Game::applyQueuedInput()
 {
-    for (int i = 0; i < spawnCount; ++i) {
-        spawnObject(QRandomGenerator::global()->bounded(1, 5));
+    InputCommand command;
+    while (input.pop(command)) {
+        applyKey(command.type, command.key, command.sequence);
+        appliedInputSequence = command.sequence;
     }
 }
 
-void Game::handleObstacleMissed(Obstacle *obstacle)
+void Game::applyKey(InputEvent::Type type, int key, quint32 sequence)
 {
-    if (!obstacle) return;
+    if (type == InputEvent::KeyPress) {
+        keys.press(key);
+        postToWorker(WorkerCommand::KeyPress, static_cast<quint64>(key), sequence);
+    } else {
+        keys.release(key);
+        postToWorker(WorkerCommand::KeyRelease, static_cast<quint64>(key), sequence);
+    }
+    if (!recordingPath.isEmpty()) {
+        recording.append(tickIndex, type, static_cast<quint64>(key));
+    }
+}
 
-    if (obstacle->getObstacleType() != Obstacle::STAR) {
-        score += 10;
+void Game::steer(int direction)
+{
+    // Направление переводится в нажатия, чтобы запись воспроизводилась без бота
+    const int current = keys.direction();
+    if (direction == current) return;
+    if (current != 0) {
+        applyKey(InputEvent::KeyRelease, current < 0 ? Qt::Key_Left : Qt::Key_Right);
+    }
+    if (direction != 0) {
+        applyKey(InputEvent::KeyPress, direction < 0 ? Qt::Key_Left : Qt::Key_Right);
     }
-    scoreText->setPlainText("Очки: " + QString::number(score));
+}
+
+void Game::setAutopilot(bool enabled)
+{
+    if (enabled == autopilotEnabled) return;
+    autopilotEnabled = enabled;
 
-    if (scene && obstacle->scene()) {
-        scene->removeItem(obstacle);
+    // В многопоточном режиме бот работает в потоке симуляции
+    postToWorker(WorkerCommand::SetAutopilot, enabled ? 1 : 0);
+    if (!enabled) {
+        steer(0);
     }
-    obstacles.removeOne(obstacle);
-    obstacle->deleteLater();
 }
 
-void Game::checkCollisions()
+void Game::tick()
 {
-    for (int i = 0; i < obstacles.size(); ++i) {
-        Obstacle *obstacle = obstacles[i];
+    ProfileScope tickScope(&profiler, Profiler::Tick);
+    TraceScope traceScope(Trace::Tick);
 
-        if (!obstacle) {
-            obstacles.removeAt(i);
-            i--;
-            continue;
+    if (replaying) {
+        applyReplayEvents();
+        // Пока игра окончена, шаги не идут: запись либо продолжится Reset
+        // на этом же шаге (уже применён), либо закончилась
+        if (replayEnded || simulation.isGameOver()) {
+            finishReplay();
+            return;
         }
+    }
 
-        if (player->collidesWithItem(obstacle)) {
-            if (obstacle->getObstacleType() == Obstacle::STAR) {
-                score += 50;
-                scoreText->setPlainText("Очки: " + QString::number(score));
-                qDebug() << "Собрана звезда! +50 очков";
-
-            } else if (obstacle->getObstacleType() == Obstacle::HEART) {
-                int currentLives = player->getLives();
-                if (currentLives < 5) {
-                    player->increaseLife();
-                    livesText->setPlainText("Жизни: " + QString::number(player->getLives()));
-                    livesText->setDefaultTextColor(Qt::green);
-                    qDebug() << "Собрано сердце! +1 жизнь";
-                } else {
-                    score += 25;
-                    scoreText->setPlainText("Очки: " + QString::number(score));
-                    qDebug() << "Максимум жизней! +25 очков вместо сердца";
-                }
+    // Ввод с клавиатуры, накопившийся с прошлого шага
+    applyQueuedInput();
 
-            } else {
-                player->decreaseLife();
-                livesText->setPlainText("Жизни: " + QString::number(player->getLives()));
-                livesText->setDefaultTextColor(player->getLives() == 1 ? Qt::red : Qt::green);
-                qDebug() << "Столкновение с препятствием! -1 жизнь";
-                checkGameOver();
-            }
+    if (autopilotEnabled && !replaying) {
+        ProfileScope scope(&profiler, Profiler::Autopilot);
+        TraceScope traceScope(Trace::Autopilot);
+        if (!autopilot) {
+            autopilot.reset(new Autopilot());
+        }
+        steer(autopilot->decide(simulation));
+    }
+
+    SimInput input;
+    input.direction = keys.direction();
+    simulation.step(GameSimulation::TickMs, input);
+    ++tickIndex;
+
+    if (tickIndex % SnapshotRing::Interval == 0 && canRestore()) {
+        ProfileScope scope(&profiler, Profiler::Snapshot);
+        history.push(tickIndex, simulation);
+    }
+
+    ProfileScope scope(&profiler, Profiler::Hud);
+    applySimulationEvents();
+}
+
+void Game::onFrameTimer()
+{
+    TraceScope traceScope(Trace::Frame);
+    const qint64 now = frameClock.nsecsElapsed();
+    const double frameMs = (now - lastFrameNs) / 1e6;
+    lastFrameNs = now;
+
+    if (worker) {
+        pollWorker(frameMs);
+        return;
+    }
+    advanceFrame(frameMs);
+}
 
-            if (scene && obstacle->scene()) scene->removeItem(obstacle);
-            obstacles.removeAt(i);
-            obstacle->deleteLater();
-            i--;
-            continue;
+void Game::pollWorker(double frameMs)
+{
+    // Кадр строится по последнему целому снимку; шаги, прошедшие между
+    // кадрами, в снимках пропускаются, а их события приходят очередью
+    if (worker->updateFrame()) {
+        const FrameSnapshot &snapshot = worker->frame();
+        if (snapshot.session == session && snapshot.tick != lastWorkerTick) {
+            lastWorkerTick = snapshot.tick;
+            profiler.addSample(Profiler::Tick, snapshot.stepCostNs);
+            if (autopilotEnabled && snapshot.autopilot.decisionNs > 0) {
+                profiler.addSample(Profiler::Autopilot, snapshot.autopilot.decisionNs);
+            }
         }
+    }
+    const FrameSnapshot &snapshot = worker->frame();
+    currentFrame = snapshot.session == session ? &snapshot : &localFrame;
 
-        if (obstacle->y() > 650) {
-            if (obstacles.contains(obstacle)) {
-                handleObstacleMissed(obstacle);
+    {
+        ProfileScope scope(&profiler, Profiler::Hud);
+        WorkerEvent event;
+        while (worker->popEvent(event)) {
+            if (event.session == session) {
+                handleSimulationEvent(event.event);
             }
-            i--;
         }
+        // Конец игры берётся из снимка: событие могло не поместиться в очередь.
+        // После перемотки снимок снова не в конце игры — надпись убирается
+        if (currentFrame->gameOver && !gameOverShown) {
+            showGameOver();
+        } else if (!currentFrame->gameOver && gameOverShown) {
+            hideGameOver();
+        } else if (currentFrame->gameOver && gameTimer->isActive()
+                   && currentFrame->restoreSequence == restoreRequest) {
+            // Поток обработал перемотку или загрузку, но восстановить было
+            // нечего: игра по-прежнему окончена, кадры больше не нужны
+            stopGame();
+        }
+        hud->setScore(currentFrame->score);
+        hud->setLives(currentFrame->lives);
     }
+
+    // Снимок отстаёт от часов потока симуляции не больше чем на шаг;
+    // интерполяция между двумя последними шагами по этому отставанию
+    const double sinceStepMs = (worker->nowNs() - currentFrame->stepNs) / 1e6;
+    renderAlpha = gameTimer->isActive() ? qBound(0.0, sinceStepMs / GameSimulation::TickMs, 1.0) : 1.0;
+    finishFrame(frameMs);
 }
 
-void Game::checkGameOver()
+void Game::advanceFrame(double frameMs)
 {
-    if (player->getLives() <= 0) {
-        stopGame();
+    // Ограничение не даёт после долгой остановки цикла догонять время
+    // десятками шагов подряд
+    const double maxFrameMs = 250.0;
+    accumulatorMs += qBound(0.0, frameMs, maxFrameMs);
+
+    while (accumulatorMs >= GameSimulation::TickMs && gameTimer->isActive()) {
+        tick();
+        // tick() мог начать новую сессию (Reset из записи) и обнулить накопитель
+        accumulatorMs = qMax(0.0, accumulatorMs - GameSimulation::TickMs);
+    }
+
+    renderAlpha = gameTimer->isActive() ? accumulatorMs / GameSimulation::TickMs : 1.0;
+    captureFrame();
+    finishFrame(frameMs);
+}
+
+void Game::captureFrame()
+{
+    localFrame.capture(simulation);
+    localFrame.session = session;
+    localFrame.tick = tickIndex;
+    localFrame.inputSequence = appliedInputSequence;
+    currentFrame = &localFrame;
+}
+
+void Game::finishFrame(double frameMs)
+{
+    {
+        ProfileScope scope(&profiler, Profiler::Sync);
+        updateCamera();
+        syncSprites();
+        // Сколько бы событий ни произошло за шаги кадра, текст раскладывается один раз
+        hud->flush();
+    }
+    {
+        ProfileScope scope(&profiler, Profiler::Particles);
+        particles.update(qBound(0.0, frameMs, 250.0));
+        particleItem->sync();
+    }
 
-        QGraphicsTextItem *gameOver = new QGraphicsTextItem("ИГРА ОКОНЧЕНА!\nНажмите R для рестарта");
-        gameOver->setDefaultTextColor(Qt::red);
-        gameOver->setFont(QFont("Arial", 24, QFont::Bold));
-        gameOver->setPos(250, 250);
-        scene->addItem(gameOver);
+    updateProfilerCounters();
+    // Оверлей обновляется ~4 раза в секунду, чтобы не искажать замеры
+    const qint64 overlayIntervalNs = 250000000;
+    const qint64 now = frameClock.nsecsElapsed();
+    if (statsText->isVisible() && now - overlayNs >= overlayIntervalNs) {
+        overlayNs = now;
+        updateStatsOverlay();
     }
 }
 
-void Game::increaseDifficulty()
+void Game::paintEvent(QPaintEvent *event)
 {
-    const double speedFactorStep = 1.15;
-    const double spawnIntervalFactor = 0.90;
-    const int spawnCountStep = 1;
+    {
+        ProfileScope scope(&profiler, Profiler::Render);
+        TraceScope traceScope(Trace::Paint);
+        QGraphicsView::paintEvent(event);
+    }
+    // Кадр показан: команды ввода, учтённые в нём, получают замер задержки
+    input.presented(currentFrame->inputSequence, inputClock.nsecsElapsed(), profiler);
+}
+
+void Game::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    if (renderBackend == SceneBackend) {
+        QGraphicsView::drawBackground(painter, rect);
+        return;
+    }
+
+    // Фон выводится готовым пикселмапом без повторной заливки кистью;
+    // смещение повторов от начала сцены, как у кисти
+    painter->drawTiledPixmap(rect, background, rect.topLeft());
+    drawSpritesDirect(painter, rect);
+}
 
-    obstacleSpeedFactor *= speedFactorStep;
+void Game::drawSpritesDirect(QPainter *painter, const QRectF &exposed)
+{
+    // Позиции берутся прямо из симуляции: никаких элементов сцены,
+    // индекса BSP и грязных областей, один вызов отрисовки на кадр
+    SpriteCache &cache = SpriteCache::instance();
+    const FrameSnapshot &frame = *currentFrame;
+    const float alpha = static_cast<float>(renderAlpha);
+
+    // В пакет попадают только спрайты, задевающие перерисовываемую область
+    const float left = static_cast<float>(exposed.left()) - GameSimulation::ObstacleSize;
+    const float right = static_cast<float>(exposed.right());
+    const float top = static_cast<float>(exposed.top()) - GameSimulation::ObstacleSize;
+    const float bottom = static_cast<float>(exposed.bottom());
 
-    for (Obstacle *ob : obstacles) {
-        if (ob) ob->multiplySpeed(speedFactorStep);
+    fragments.resize(0);
+    for (const FrameSnapshot::ObstacleState &state : frame.obstacles) {
+        const float y = FrameSnapshot::interpolatedY(state, alpha);
+        if (state.x <= left || state.x >= right || y <= top || y >= bottom) continue;
+        fragments.append(cache.fragment(state.type, QPointF(state.x, y)));
     }
 
-    if (spawnCount < maxSpawnCount) spawnCount = qMin(maxSpawnCount, spawnCount + spawnCountStep);
+    // Прозрачность элемента игрока по-прежнему отражает мигание при уроне
+    fragments.append(cache.fragment(SpriteCache::PLAYER,
+                                    QPointF(frame.interpolatedPlayerX(renderAlpha), frame.playerY),
+                                    player->opacity()));
+
+    painter->drawPixmapFragments(fragments.constData(), fragments.size(), cache.atlas());
+}
+
+void Game::updateProfilerCounters()
+{
+    const CollisionStats &collisions = currentFrame->collisions;
+    profiler.setCounter(Profiler::LiveObstacles, currentFrame->obstacles.size());
+    profiler.setCounter(Profiler::PoolFree, obstaclePool->freeCount());
+    profiler.setCounter(Profiler::PoolAllocations, static_cast<qint64>(obstaclePool->allocations()));
+    profiler.setCounter(Profiler::SpriteRasterizations, static_cast<qint64>(SpriteCache::instance().misses()));
+    profiler.setCounter(Profiler::CandidatePairs, collisions.candidatePairs);
+    profiler.setCounter(Profiler::NarrowTests, collisions.narrowTests);
+    profiler.setCounter(Profiler::HudRelayouts, static_cast<qint64>(hud->relayouts()));
+    profiler.setCounter(Profiler::LiveParticles, particles.size());
 
-    spawnIntervalMs = qMax(150, static_cast<int>(std::round(spawnIntervalMs * spawnIntervalFactor)));
-    if (spawnTimer) spawnTimer->start(spawnIntervalMs);
+    // В потоке симуляции бот свой, его работа приходит в снимке
+    AutopilotStats bot;
+    if (autopilotEnabled) {
+        bot = worker ? currentFrame->autopilot : (autopilot ? autopilot->getStats() : AutopilotStats());
+    }
+    profiler.setCounter(Profiler::AutopilotRollouts, bot.rollouts);
+    profiler.setCounter(Profiler::AutopilotSteps, bot.steps);
+}
 
-    qDebug() << "Difficulty increased: speedFactor=" << obstacleSpeedFactor
-             << " spawnCount=" << spawnCount << " spawnIntervalMs=" << spawnIntervalMs;
+void Game::updateStatsOverlay()
+{
+    if (!statsText->isVisible()) return;
+    statsText->setPlainText(profiler.summary() + QLatin1Char('\n') + input.histogramText());
+}
+
+void Game::applyReplayEvents()
+{
+    const QVector<InputEvent> &events = replayLog.getEvents();
+    while (replayCursor < events.size() && events[replayCursor].tick <= tickIndex) {
+        const InputEvent &event = events[replayCursor++];
+        switch (event.type) {
+        case InputEvent::KeyPress:
+            keys.press(static_cast<int>(event.value));
+            break;
+        case InputEvent::KeyRelease:
+            keys.release(static_cast<int>(event.value));
+            break;
+        case InputEvent::Reset:
+            resetSession(event.value);
+            startGame();
+            break;
+        case InputEvent::End:
+            replayEnded = true;
+            break;
+        }
+    }
+}
+
+void Game::dumpTrace()
+{
+    if (!Trace::isEnabled()) {
+        qWarning() << "Трасса выключена";
+        return;
+    }
+    const QString path = QStringLiteral("trace-%1.json")
+                             .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-hhmmss")));
+    if (Trace::writeChromeJson(path)) {
+        qInfo() << "Трасса сохранена в" << path;
+    } else {
+        qWarning() << "Не удалось сохранить трассу в" << path;
+    }
+}
+
+void Game::finishReplay()
+{
+    stopGame();
+    replaying = false;
+    qInfo().noquote() << "Replay finished: ticks=" << tickIndex
+                      << " score=" << simulation.getScore()
+                      << " lives=" << simulation.getLives()
+                      << " hash=" << QString::number(simulation.stateHash(), 16);
+}
+
+void Game::applySimulationEvents()
+{
+    simulation.traceEvents();
+    for (const SimEvent &event : simulation.events()) {
+        handleSimulationEvent(event);
+    }
+
+    // Только отметка изменений; текст обновится в конце кадра
+    hud->setScore(simulation.getScore());
+    hud->setLives(simulation.getLives());
+}
+
+void Game::handleSimulationEvent(const SimEvent &event)
+{
+    // Спрайты следуют за снимком в syncSprites(); здесь только оформление.
+    // Журнал событий — трасса (Trace), а не qDebug() в горячем пути
+    switch (event.kind) {
+    case SimEvent::Spawned:
+    case SimEvent::Missed:
+    case SimEvent::DifficultyIncreased:
+        break;
+
+    case SimEvent::StarCollected:
+    case SimEvent::HeartCollected:
+    case SimEvent::HeartConverted:
+        spawnEffect(event);
+        break;
+
+    case SimEvent::Hit:
+        spawnEffect(event);
+        player->showDamage();
+        break;
+
+    case SimEvent::GameOver:
+        if (!gameOverShown) {
+            showGameOver();
+        }
+        break;
+    }
+}
+
+void Game::spawnEffect(const SimEvent &event)
+{
+    switch (event.type) {
+    case GameSimulation::Bomb:
+        particles.burst(ParticleSystem::Spark, event.x, event.y, 160);
+        particles.burst(ParticleSystem::Smoke, event.x, event.y, 60);
+        break;
+    case GameSimulation::Rock:
+        particles.burst(ParticleSystem::Spark, event.x, event.y, 50);
+        particles.burst(ParticleSystem::Smoke, event.x, event.y, 40);
+        break;
+    case GameSimulation::Heart:
+        particles.burst(ParticleSystem::HeartGlow, event.x, event.y, 90);
+        break;
+    case GameSimulation::Star:
+        particles.burst(ParticleSystem::StarGlow, event.x, event.y, 120);
+        break;
+    }
+}
+
+void Game::syncSprites()
+{
+    if (renderBackend == DirectBackend) {
+        // Сцена не знает о движении: кадр перерисовывается целиком
+        viewport()->update();
+        return;
+    }
+
+    // Спрайты повторяют снимок: слоты без живого препятствия возвращаются
+    // в пул, новые берутся из него; позиции интерполируются между двумя
+    // последними шагами. Препятствия вне камеры спрайтов не получают,
+    // поэтому число элементов сцены не зависит от размеров мира
+    const FrameSnapshot &frame = *currentFrame;
+    const float alpha = static_cast<float>(renderAlpha);
+    const float left = static_cast<float>(camera.left()) - GameSimulation::ObstacleSize;
+    const float right = static_cast<float>(camera.right());
+    const float top = static_cast<float>(camera.top()) - GameSimulation::ObstacleSize;
+    const float bottom = static_cast<float>(camera.bottom());
+    if (obstacleSprites.size() < frame.slotCount) {
+        obstacleSprites.resize(frame.slotCount);
+    }
+    spriteSeen.fill(0, obstacleSprites.size());
+
+    for (const FrameSnapshot::ObstacleState &state : frame.obstacles) {
+        const float y = FrameSnapshot::interpolatedY(state, alpha);
+        if (state.x <= left || state.x >= right || y <= top || y >= bottom) continue;
+
+        Obstacle *&sprite = obstacleSprites[state.slot];
+        const Obstacle::ObstacleType type = static_cast<Obstacle::ObstacleType>(state.type);
+        if (sprite && sprite->getObstacleType() != type) {
+            obstaclePool->release(sprite);
+            sprite = nullptr;
+        }
+        if (!sprite) {
+            sprite = obstaclePool->acquire(type);
+        }
+        sprite->setPos(state.x, y);
+        spriteSeen[state.slot] = 1;
+    }
+    for (int slot = 0; slot < obstacleSprites.size(); ++slot) {
+        if (!spriteSeen[slot]) {
+            releaseSprite(slot);
+        }
+    }
+
+    player->setPos(frame.interpolatedPlayerX(renderAlpha), frame.playerY);
+}
+
+void Game::releaseSprite(int slot)
+{
+    if (slot < 0 || slot >= obstacleSprites.size() || !obstacleSprites[slot]) return;
+    obstaclePool->release(obstacleSprites[slot]);
+    obstacleSprites[slot] = nullptr;
+}
+
+void Game::releaseAllSprites()
+{
+    for (Obstacle *sprite : obstacleSprites) {
+        obstaclePool->release(sprite);
+    }
+    obstacleSprites.resize(0);
+}
+
+void Game::showGameOver()
+{
+    gameOverShown = true;
+    // При воспроизведении таймер продолжает идти, чтобы применить Reset из записи
+    if (!replaying) {
+        stopGame();
+        saveRecording();
+    }
+
+    gameOverText->show();
+}
+
+void Game::hideGameOver()
+{
+    gameOverShown = false;
+    gameOverText->hide();
 }
@@ -5,10 +5,26 @@
 #include <QGraphicsScene>
 #include <QGraphicsView>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QKeyEvent>
 #include <QGraphicsTextItem>
+#include <QGraphicsRectItem>
+#include <QPainter>
 #include "player.h"
 #include "obstacle.h"
+#include "obstaclepool.h"
+#include "gamesimulation.h"
+#include "inputrecording.h"
+#include "profiler.h"
+#include "huditem.h"
+#include "framesnapshot.h"
+#include "simulationworker.h"
+#include "autopilot.h"
+#include "snapshotring.h"
+#include "particlesystem.h"
+#include "particleitem.h"
+#include "inputqueue.h"
+#include <memory>
 #include "gameobject.h"
 
 // Интерфейс для игровой логики
@@ -38,62 +54,241 @@ protected:
     void showEvent(QShowEvent *event) override {
         QGraphicsView::showEvent(event);
         setFocus();
+        setPaused(WindowHidden, false);
     }
+    void hideEvent(QHideEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
 
 public:
+    // Причины паузы; игра стоит, пока есть хотя бы одна
+    enum PauseReason {
+        UserPause = 0x1,        // клавиша P / Pause
+        WindowHidden = 0x2,
+        WindowMinimized = 0x4,
+        WindowInactive = 0x8    // окно потеряло фокус
+    };
+
+    // Способ отрисовки: элементы QGraphicsScene или прямой вывод фона и
+    // всех спрайтов из состояния симуляции одним пакетом по атласу
+    enum RenderBackend { SceneBackend, DirectBackend };
+
     explicit Game(QWidget *parent = nullptr);
-    ~Game() override = default;
+    ~Game() override;
 
     // Реализация интерфейса IGameLogic
     void startGame() override;
     void stopGame() override;
     void resetGame() override;
-    bool isGameOver() const override { return player->getLives() <= 0; }
+    bool isGameOver() const override;
+
+    // Новая сессия с заданным seed (resetGame() выбирает seed случайно)
+    void resetSession(quint64 seed);
+
+    // Запись ввода в файл (сохраняется при конце игры и при закрытии)
+    void startRecording(const QString &path);
+    // Воспроизведение записи вместо ввода с клавиатуры
+    void startReplay(const InputRecording &recording);
 
     // Реализация интерфейса IObjectManager
     void spawnObject(int type) override;
     void removeAllObjects() override;
-    int getObjectCount() const override { return obstacles.size(); }
+    int getObjectCount() const override;
+
+    // Симуляция в отдельном потоке: шаги идут по часам потока и не зависят
+    // от отрисовки, кадр строится по последнему опубликованному снимку.
+    // Запись и воспроизведение ввода работают только в однопоточном режиме.
+    void setThreadedSimulation(bool enabled);
+    bool isThreadedSimulation() const { return worker != nullptr; }
+
+    // Управление ботом с поиском вперёд (клавиша A). Решения бота
+    // проходят как нажатия клавиш и попадают в запись ввода
+    void setAutopilot(bool enabled);
+    bool isAutopilot() const { return autopilotEnabled; }
+
+    // Пауза без пробуждений: кадровый таймер остановлен, поток симуляции
+    // спит на семафоре, сцена не перерисовывается. Снимается последняя
+    // причина — игра продолжается с того же шага без скачка времени
+    // (если до паузы она шла, а не закончилась)
+    void setPaused(PauseReason reason, bool paused);
+    bool isPaused() const { return pauseReasons != 0; }
+
+    // Перемотка назад по кольцу снимков (Backspace) и быстрое сохранение
+    // в память (F5 / F9). Во время записи и воспроизведения недоступны:
+    // запись ввода описывает одну непрерывную ветку событий
+    void rewind(quint32 ticksBack = RewindTicks);
+    void quickSave();
+    void quickLoad();
+
+    // Размеры мира: окно остаётся размером в экран, камера следует за
+    // игроком по горизонтали. Начинает новую сессию с тем же seed.
+    // Запись ввода размеры мира не хранит — только мир по умолчанию
+    void setWorldParams(const WorldParams &params);
+
+    // Настройки симуляции применяются при следующем resetSession()
+    GameSimulation &getSimulation() { return simulation; }
+    const GameSimulation &getSimulation() const { return simulation; }
+    const CollisionStats &getCollisionStats() const { return simulation.getCollisionStats(); }
+    Profiler &getProfiler() { return profiler; }
+    const Profiler &getProfiler() const { return profiler; }
+    ParticleSystem &getParticles() { return particles; }
 
     // Обработчики событий клавиатуры
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
 
+    // Частота отрисовки не зависит от частоты симуляции
+    void setRenderIntervalMs(int intervalMs);
+
+    void setRenderBackend(RenderBackend backend);
+    RenderBackend getRenderBackend() const { return renderBackend; }
+
+    // Кадр: выполняет накопившиеся фиксированные шаги симуляции и
+    // интерполирует позиции спрайтов между двумя последними шагами
+    void advanceFrame(double frameMs);
+
+public slots:
+    // Один фиксированный шаг симуляции (GameSimulation::TickMs)
+    void tick();
+
 private slots:
-    void spawnObstacle();
-    void checkCollisions();
-    void handleObstacleMissed(Obstacle *obstacle);
-    void increaseDifficulty();
-    void movePlayer();
-    void checkGameOver();
+    void onFrameTimer();
 
 private:
+    // Отображение результатов шага симуляции
+    void applySimulationEvents();
+    void handleSimulationEvent(const SimEvent &event);
+    void captureFrame();
+    void finishFrame(double frameMs);
+    // Сцена и фон под размеры мира из simulation
+    void resizeScene();
+    // Видимая область следует за игроком; HUD и надписи — вместе с ней
+    void updateCamera();
+    void spawnEffect(const SimEvent &event);
+    void syncSprites();
+    void drawSpritesDirect(QPainter *painter, const QRectF &exposed);
+    void releaseSprite(int slot);
+    void releaseAllSprites();
+
+    // Ввод клавиш ← →: клавиатура ставит команды в очередь input,
+    // они применяются в начале шага (в потоке симуляции — сразу
+    // передаются в его очередь команд). Автопилот применяет клавиши
+    // напрямую, он и так работает в начале шага
+    void queueInput(InputEvent::Type type, int key);
+    void applyQueuedInput();
+    void applyKey(InputEvent::Type type, int key, quint32 sequence = 0);
+    void steer(int direction);
+
+    // Многопоточный режим: снимки и события из потока симуляции.
+    // Поток получает копию настроенной simulation при запуске
+    void startWorker();
+    void stopWorker();
+    void pollWorker(double frameMs);
+    void postToWorker(WorkerCommand::Type type, quint64 value = 0, quint32 sequence = 0);
+    void showGameOver();
+    void hideGameOver();
+
+    // Снимок восстановлен: кадр, HUD и надпись конца игры по новому состоянию
+    void afterRestore(quint32 restoredTick);
+    bool canRestore() const { return recordingPath.isEmpty() && !replaying; }
+
+    // Воспроизведение: применяет события записи для текущего шага
+    void applyReplayEvents();
+    void finishReplay();
+    void saveRecording();
+
+    // Счётчики профилировщика и оверлей (F3)
+    void updateProfilerCounters();
+    void updateStatsOverlay();
+    // Выгрузка трассы последних секунд в trace-<время>.json (F2)
+    void dumpTrace();
+
+private:
+    // Перемотка по Backspace: ~2 с игры
+    static constexpr quint32 RewindTicks = 120;
+
     QGraphicsScene *scene = nullptr;
 
-    // Таймеры
+    // Единственный таймер — кадровый; шаги симуляции отсчитываются
+    // по реальному времени с фиксированным шагом
     QTimer *gameTimer = nullptr;
-    QTimer *spawnTimer = nullptr;
-    QTimer *difficultyTimer = nullptr;
-    QTimer *playerMoveTimer = nullptr;
+    QElapsedTimer frameClock;
+    qint64 lastFrameNs = 0;
+    double accumulatorMs = 0.0;
+    double renderAlpha = 1.0;
+    int renderIntervalMs = 8;
+
+    // Игровые правила и состояние. В многопоточном режиме шаги выполняет
+    // копия в потоке worker, а simulation хранит только настройки
+    GameSimulation simulation;
+    SimulationWorker *worker = nullptr;
+    quint32 session = 0;
+    quint32 lastWorkerTick = 0;
+    // Номер последнего запроса перемотки или загрузки, отправленного потоку
+    quint32 restoreRequest = 0;
+
+    // Кадр рисуется по currentFrame: локальному снимку simulation
+    // или последнему снимку потока симуляции
+    FrameSnapshot localFrame;
+    const FrameSnapshot *currentFrame = &localFrame;
+    bool gameOverShown = false;
+
+    // Отрисовка
+    RenderBackend renderBackend = SceneBackend;
+    QPixmap background;
+    QVector<QPainter::PixmapFragment> fragments;
+
+    // Видимая область мира в координатах сцены
+    QRectF camera;
 
     // Игровые объекты
     Player *player = nullptr;
-    QGraphicsTextItem *scoreText = nullptr;
-    QGraphicsTextItem *livesText = nullptr;
-
-    // Счёт и список препятствий
-    int score = 0;
-    QList<Obstacle*> obstacles;
-
-    // Параметры сложности и спавна
-    double obstacleSpeedFactor = 1.0;
-    int spawnIntervalMs = 800;
-    int spawnCount = 1;
-    int maxSpawnCount = 5;
-
-    // Параметры управления игроком
-    int playerDirection = 0;
-    int playerSpeed = 8;
+    // Родитель элементов, привязанных к экрану, а не к миру
+    QGraphicsRectItem *screenLayer = nullptr;
+    HudItem *hud = nullptr;
+    QGraphicsTextItem *statsText = nullptr;
+    QGraphicsTextItem *gameOverText = nullptr;
+    QGraphicsTextItem *pauseText = nullptr;
+
+    // Пауза: причины и нужно ли возобновить игру после снятия последней
+    int pauseReasons = 0;
+    bool resumeAfterPause = false;
+
+    // Спрайты препятствий, индексированные номером слота ObstacleStore
+    QVector<Obstacle*> obstacleSprites;
+    QVector<quint8> spriteSeen;
+    ObstaclePool *obstaclePool = nullptr;
+
+    // Эффекты: частицы живут по времени кадров, а не шагов симуляции
+    ParticleSystem particles;
+    ParticleItem *particleItem = nullptr;
+
+    // Профилирование
+    Profiler profiler;
+    qint64 overlayNs = 0;
+
+    // Управление игроком
+    InputQueue input;
+    QElapsedTimer inputClock;
+    quint32 appliedInputSequence = 0;
+    KeyDirection keys;
+    bool autopilotEnabled = false;
+    std::unique_ptr<Autopilot> autopilot;
+
+    // Снимки однопоточного пути; в многопоточном их ведёт поток симуляции
+    SnapshotRing history;
+    QByteArray quickSaveState;
+    quint32 quickSaveTick = 0;
+
+    // Запись и воспроизведение ввода; tickIndex — число выполненных шагов
+    quint32 tickIndex = 0;
+    InputRecording recording;
+    QString recordingPath;
+    bool replaying = false;
+    InputRecording replayLog;
+    int replayCursor = 0;
+    bool replayEnded = false;
 };
 
 #endif // GAME_H
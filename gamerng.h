@@ -0,0 +1,46 @@
+#ifndef GAMERNG_H
+#define GAMERNG_H
+
+#include <QtGlobal>
+
+// Детерминированный генератор случайных чисел (PCG32) для симуляции.
+// Вся последовательность задаётся seed, а состояние — одним 64-битным
+// словом, поэтому сессию можно воспроизвести и сохранить в снимок.
+class GameRng
+{
+public:
+    explicit GameRng(quint64 seed = 0) { reseed(seed); }
+
+    void reseed(quint64 seed)
+    {
+        state = 0;
+        generate();
+        state += seed;
+        generate();
+    }
+
+    quint32 generate()
+    {
+        const quint64 old = state;
+        state = old * 6364136223846793005ULL + Increment;
+        const quint32 xorshifted = static_cast<quint32>(((old >> 18u) ^ old) >> 27u);
+        const quint32 rot = static_cast<quint32>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // Равномерное целое в [lowest, highest), как QRandomGenerator::bounded()
+    int bounded(int lowest, int highest)
+    {
+        const quint64 range = static_cast<quint64>(static_cast<qint64>(highest) - lowest);
+        return lowest + static_cast<int>((static_cast<quint64>(generate()) * range) >> 32);
+    }
+
+    quint64 getState() const { return state; }
+    void setState(quint64 value) { state = value; }
+
+private:
+    static constexpr quint64 Increment = 1442695040888963407ULL;
+    quint64 state = 0;
+};
+
+#endif // GAMERNG_H
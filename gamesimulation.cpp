@@ -0,0 +1,483 @@
+#include "gamesimulation.h"
+#include "sweptaabb.h"
+#include "trace.h"
+#include <QDataStream>
+#include <cstring>
+#include <QRectF>
+#include <algorithm>
+#include <cmath>
+
+GameSimulation::GameSimulation()
+{
+    obstacles.reserve(512);
+    obstacles.setExitY(FieldHeight);
+    eventQueue.reserve(64);
+}
+
+void GameSimulation::setCollisionMasks(const QVector<CollisionMask> &spriteMasks)
+{
+    masks = spriteMasks;
+}
+
+void GameSimulation::setWorldParams(const WorldParams &params)
+{
+    world.width = qMax(params.width, FieldWidth);
+    world.activeWidth = qBound(FieldWidth, params.activeWidth, world.width);
+}
+
+void GameSimulation::applyWorldGeometry()
+{
+    collisionGrid = CollisionGrid(QRectF(0, -256, world.activeWidth, FieldHeight + 360), 64);
+}
+
+double GameSimulation::getActiveLeft() const
+{
+    return qBound(0.0, playerX + PlayerSize / 2.0 - world.activeWidth / 2.0,
+                  static_cast<double>(world.width - world.activeWidth));
+}
+
+void GameSimulation::reset(quint64 sessionSeed)
+{
+    seed = sessionSeed;
+    rng.reseed(seed);
+
+    obstacles.clear();
+    obstacles.setExitY(FieldHeight);
+    eventQueue.resize(0);
+    collisionStats = CollisionStats();
+    applyWorldGeometry();
+
+    // Старт в середине мира, у нижнего края
+    playerX = (world.width - PlayerSize) / 2.0;
+    previousPlayerX = playerX;
+    lives = StartLives;
+    score = 0;
+    gameOver = false;
+
+    timeMs = 0.0;
+    spawnElapsedMs = 0.0;
+    difficultyElapsedMs = 0.0;
+
+    obstacleSpeedFactor = 1.0;
+    spawnIntervalMs = difficulty.spawnIntervalMs;
+    spawnCount = difficulty.spawnCount;
+}
+
+void GameSimulation::step(double dtMs, const SimInput &input)
+{
+    eventQueue.resize(0);
+    if (gameOver || dtMs <= 0.0) return;
+
+    timeMs += dtMs;
+    const double ticks = dtMs / TickMs;
+
+    // Порядок шага: игрок -> препятствия -> столкновения -> вылеты -> спавн и сложность.
+    // Вылеты проверяются после столкновений: быстрое препятствие может за
+    // один шаг пройти сквозь игрока и покинуть поле
+    {
+        ProfileScope scope(profiler, Profiler::Movement);
+        movePlayer(ticks, input.direction);
+        obstacles.advance(getTimeTicks());
+    }
+    {
+        ProfileScope scope(profiler, Profiler::Collision);
+        checkCollisions(ticks);
+    }
+    expireObstacles();
+    if (gameOver) return;
+
+    spawnElapsedMs += dtMs;
+    if (spawnElapsedMs >= spawnIntervalMs) {
+        // Замеряются только шаги, на которых действительно был спавн
+        ProfileScope scope(profiler, Profiler::Spawn);
+        while (spawnElapsedMs >= spawnIntervalMs) {
+            spawnElapsedMs -= spawnIntervalMs;
+            spawnWave();
+        }
+    }
+
+    if (difficulty.periodMs > 0) {
+        difficultyElapsedMs += dtMs;
+        while (difficultyElapsedMs >= difficulty.periodMs) {
+            difficultyElapsedMs -= difficulty.periodMs;
+            increaseDifficulty();
+        }
+    }
+}
+
+void GameSimulation::pushEvent(SimEvent::Kind kind, int slot, int type, float x, float y)
+{
+    SimEvent event;
+    event.kind = kind;
+    event.slot = slot;
+    event.type = type;
+    event.x = x;
+    event.y = y;
+    eventQueue.append(event);
+}
+
+void GameSimulation::traceEvents() const
+{
+    if (!Trace::isEnabled()) return;
+
+    for (const SimEvent &event : eventQueue) {
+        switch (event.kind) {
+        case SimEvent::Spawned:
+            Trace::instant(Trace::Spawn, event.type, event.slot);
+            break;
+        case SimEvent::Missed:
+            Trace::instant(Trace::Miss, event.type, event.slot);
+            break;
+        case SimEvent::StarCollected:
+        case SimEvent::HeartCollected:
+        case SimEvent::HeartConverted:
+            Trace::instant(Trace::Pickup, event.type, score);
+            break;
+        case SimEvent::Hit:
+            Trace::instant(Trace::Hit, event.type, lives);
+            break;
+        case SimEvent::DifficultyIncreased:
+            Trace::instant(Trace::Difficulty, spawnIntervalMs, qRound(obstacleSpeedFactor * 1000.0));
+            break;
+        case SimEvent::GameOver:
+            Trace::instant(Trace::GameOver, score);
+            break;
+        }
+    }
+}
+
+void GameSimulation::movePlayer(double ticks, int direction)
+{
+    previousPlayerX = playerX;
+    if (direction == 0) return;
+
+    const double step = playerSpeed * ticks;
+    playerX = qBound(0.0, playerX + (direction < 0 ? -step : step),
+                     static_cast<double>(world.width - PlayerSize));
+}
+
+void GameSimulation::expireObstacles()
+{
+    // Вылет проверяется не по позициям всех препятствий, а по куче моментов вылета
+    missedSlots.resize(0);
+    obstacles.collectExpired(getTimeTicks(), missedSlots);
+    for (int slot : missedSlots) {
+        const int type = obstacles.type(slot);
+        if (type != Star) {
+            score += 10;
+        }
+        obstacles.remove(slot);
+        pushEvent(SimEvent::Missed, slot, type);
+    }
+}
+
+void GameSimulation::checkCollisions(double ticks)
+{
+    // Проверка непрерывная: препятствие движется от previousY() к y(),
+    // игрок — от previousPlayerX к playerX. Считается в системе координат
+    // игрока, где препятствие смещается на разность перемещений, поэтому
+    // попадания не теряются при любой скорости и длине шага.
+    // Запас в 1 px: отсечение должно быть не строже точной проверки
+    const QRectF playerBox = QRectF(0, 0, PlayerSize, PlayerSize).adjusted(-1, -1, 1, 1);
+    const double playerDx = playerX - previousPlayerX;
+
+    // Широкая фаза: сетка построена по текущим позициям, поэтому область
+    // запроса — заметание игрока, продлённое вниз на наибольшее смещение
+    // препятствия за шаг
+    const QRectF sweptPlayer = QRectF(qMin(playerX, previousPlayerX), PlayerY,
+                                      PlayerSize + qAbs(playerDx), PlayerSize)
+                                   .adjusted(-1, -1, 1, 1 + obstacles.maxSpeed() * ticks);
+    // Сетка окружает игрока; препятствия вне её попадают в крайние ячейки,
+    // до которых запрос у игрока не дотягивается
+    collisionGrid.moveTo(QPointF(getActiveLeft(), -256));
+    collisionGrid.build(obstacles, ObstacleSize);
+    candidateSlots.resize(0);
+    collisionGrid.query(sweptPlayer, candidateSlots);
+    // Порядок обработки как при полном обходе — по возрастанию слота
+    std::sort(candidateSlots.begin(), candidateSlots.end());
+
+    // Отсечение заметённым AABB и сбор пакета для узкой фазы: для каждого
+    // кандидата — выборки относительного положения с шагом не больше
+    // пикселя на отрезке времени, где AABB пересекаются
+    const bool haveMasks = masks.size() > Star;
+    narrowSlots.resize(0);
+    narrowOwners.resize(0);
+    narrowMasks.resize(0);
+    narrowPositions.resize(0);
+    for (int slot : candidateSlots) {
+        const QRectF startBox(obstacles.x(slot) - previousPlayerX, obstacles.previousY(slot) - PlayerY,
+                              ObstacleSize, ObstacleSize);
+        const QPointF displacement(-playerDx, obstacles.y(slot) - obstacles.previousY(slot));
+        const SweepResult sweep = sweepAabb(startBox, displacement, playerBox);
+        if (!sweep.hit) continue;
+
+        const int candidate = narrowSlots.size();
+        narrowSlots.append(slot);
+        if (!haveMasks) continue;
+
+        const double span = sweep.exit - sweep.enter;
+        const double distance = qMax(qAbs(displacement.x()), qAbs(displacement.y())) * span;
+        const int steps = qMax(1, static_cast<int>(std::ceil(distance)));
+        const CollisionMask *mask = &masks.at(obstacles.type(slot));
+        for (int s = steps; s >= 0; --s) {
+            // Первой идёт конечная позиция — та же, что у дискретной проверки
+            const double t = sweep.enter + span * s / steps;
+            narrowOwners.append(candidate);
+            narrowMasks.append(mask);
+            narrowPositions.append(QPoint(qRound(startBox.x() + displacement.x() * t),
+                                          qRound(startBox.y() + displacement.y() * t)));
+        }
+    }
+
+    collisionStats.candidatePairs = candidateSlots.size();
+    collisionStats.narrowTests = narrowMasks.size();
+    if (narrowSlots.isEmpty()) return;
+
+    // Узкая фаза: попиксельная проверка масок одним пакетом
+    candidateHits.resize(narrowSlots.size());
+    if (haveMasks) {
+        candidateHits.fill(0);
+        narrowHits.resize(narrowMasks.size());
+        CollisionMask::overlapsBatch(masks.at(0), QPoint(0, 0),
+                                     narrowMasks.constData(), narrowPositions.constData(),
+                                     narrowMasks.size(), narrowHits.data());
+        for (int i = 0; i < narrowHits.size(); ++i) {
+            candidateHits[narrowOwners[i]] |= narrowHits[i];
+        }
+    } else {
+        candidateHits.fill(1);
+    }
+
+    for (int i = 0; i < narrowSlots.size(); ++i) {
+        if (candidateHits[i]) {
+            handleHit(narrowSlots[i]);
+        }
+    }
+}
+
+void GameSimulation::handleHit(int slot)
+{
+    const int type = obstacles.type(slot);
+    const float x = obstacles.x(slot) + ObstacleSize / 2.0f;
+    const float y = obstacles.y(slot) + ObstacleSize / 2.0f;
+    obstacles.remove(slot);
+
+    if (type == Star) {
+        score += 50;
+        pushEvent(SimEvent::StarCollected, slot, type, x, y);
+    } else if (type == Heart) {
+        if (lives < MaxLives) {
+            ++lives;
+            pushEvent(SimEvent::HeartCollected, slot, type, x, y);
+        } else {
+            score += 25;
+            pushEvent(SimEvent::HeartConverted, slot, type, x, y);
+        }
+    } else {
+        if (lives > 0 && !invulnerable) {
+            --lives;
+        }
+        pushEvent(SimEvent::Hit, slot, type, x, y);
+        if (lives <= 0 && !gameOver) {
+            gameOver = true;
+            pushEvent(SimEvent::GameOver);
+        }
+    }
+}
+
+void GameSimulation::spawnObject(int type)
+{
+    // Препятствия появляются только в активной области вокруг игрока
+    const int x = static_cast<int>(getActiveLeft()) + rng.bounded(20, world.activeWidth - 40);
+    const int y = -50 - rng.bounded(0, 200);
+    double speed = rng.bounded(3, 8);
+    if (obstacleSpeedFactor != 1.0) {
+        speed = qMax(1.0, std::round(speed * obstacleSpeedFactor));
+    }
+
+    const int slot = obstacles.spawn(type, x, y, static_cast<float>(speed), getTimeTicks());
+    pushEvent(SimEvent::Spawned, slot, type);
+}
+
+void GameSimulation::removeAllObjects()
+{
+    obstacles.clear();
+}
+
+void GameSimulation::spawnWave()
+{
+    for (int i = 0; i < spawnCount; ++i) {
+        spawnObject(rng.bounded(1, 5));
+    }
+}
+
+void GameSimulation::increaseDifficulty()
+{
+    const int spawnCountStep = 1;
+
+    obstacleSpeedFactor *= difficulty.speedFactorStep;
+    obstacles.scaleSpeeds(difficulty.speedFactorStep, getTimeTicks());
+
+    if (spawnCount < difficulty.maxSpawnCount) {
+        spawnCount = qMin(difficulty.maxSpawnCount, spawnCount + spawnCountStep);
+    }
+
+    spawnIntervalMs = qMax(difficulty.minSpawnIntervalMs,
+                           static_cast<int>(std::round(spawnIntervalMs * difficulty.spawnIntervalFactor)));
+    // Как и перезапуск spawnTimer раньше: отсчёт спавна начинается заново
+    spawnElapsedMs = 0.0;
+
+    pushEvent(SimEvent::DifficultyIncreased);
+}
+
+namespace {
+// FNV-1a по байтам значения
+template <typename T>
+void hashValue(quint64 &hash, const T &value)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (unsigned char byte : bytes) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+}
+
+const quint32 StateMagic = 0x46475353; // "FGSS"
+const quint16 StateVersion = 3;
+}
+
+QByteArray GameSimulation::saveState() const
+{
+    QByteArray buffer;
+    saveState(buffer);
+    return buffer;
+}
+
+void GameSimulation::saveState(QByteArray &buffer) const
+{
+    // В Qt 5 resize(0) освобождает память, если ёмкость не зарезервирована;
+    // reserve() под прошлый размер оставляет буфер кольца снимков на месте
+    buffer.reserve(qMax(buffer.capacity(), buffer.size()));
+    buffer.resize(0);
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+
+    out << StateMagic << StateVersion;
+    out << seed << rng.getState();
+    out << qint32(world.width) << qint32(world.activeWidth);
+    out << timeMs << spawnElapsedMs << difficultyElapsedMs;
+    out << playerX << previousPlayerX << qint32(lives) << qint32(score) << gameOver;
+    out << qint32(difficulty.spawnIntervalMs) << qint32(difficulty.spawnCount)
+        << qint32(difficulty.maxSpawnCount) << qint32(difficulty.minSpawnIntervalMs)
+        << qint32(difficulty.periodMs) << difficulty.speedFactorStep
+        << difficulty.spawnIntervalFactor;
+    out << obstacleSpeedFactor << qint32(spawnIntervalMs) << qint32(spawnCount);
+    obstacles.save(out);
+}
+
+bool GameSimulation::restoreState(const QByteArray &buffer)
+{
+    QDataStream in(buffer);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != StateMagic || version != StateVersion) return false;
+
+    // Снимок читается целиком во временные переменные и применяется
+    // только после успешного разбора
+    quint64 savedSeed = 0, rngState = 0;
+    double savedTime = 0.0, savedSpawnElapsed = 0.0, savedDifficultyElapsed = 0.0;
+    double savedX = 0.0, savedPreviousX = 0.0;
+    qint32 savedLives = 0, savedScore = 0;
+    bool savedGameOver = false;
+    qint32 worldWidth = 0, activeWidth = 0;
+    qint32 interval = 0, count = 0, maxCount = 0, minInterval = 0, period = 0;
+    double speedStep = 0.0, intervalFactor = 0.0;
+    double savedSpeedFactor = 0.0;
+    qint32 savedSpawnInterval = 0, savedSpawnCount = 0;
+
+    in >> savedSeed >> rngState;
+    in >> worldWidth >> activeWidth;
+    in >> savedTime >> savedSpawnElapsed >> savedDifficultyElapsed;
+    in >> savedX >> savedPreviousX >> savedLives >> savedScore >> savedGameOver;
+    in >> interval >> count >> maxCount >> minInterval >> period >> speedStep >> intervalFactor;
+    in >> savedSpeedFactor >> savedSpawnInterval >> savedSpawnCount;
+    if (in.status() != QDataStream::Ok) return false;
+
+    // Значения вне диапазонов, которых не бывает в игре, отвергаются: нулевой
+    // интервал зациклил бы спавн в step(), NaN испортил бы все траектории.
+    // Между шагами накопленное время спавна меньше интервала, сложности — периода
+    auto positive = [](double value) { return std::isfinite(value) && value > 0.0; };
+    if (!std::isfinite(savedTime) || savedTime < 0.0
+        || !std::isfinite(savedX) || !std::isfinite(savedPreviousX)
+        || savedLives < 0 || savedLives > MaxLives || savedScore < 0
+        || interval < 1 || minInterval < 1 || savedSpawnInterval < 1
+        || count < 0 || maxCount < 1 || savedSpawnCount < 0 || period < 0
+        || !positive(speedStep) || !positive(intervalFactor) || !positive(savedSpeedFactor)
+        || !(savedSpawnElapsed >= 0.0 && savedSpawnElapsed < savedSpawnInterval)
+        || !(savedDifficultyElapsed >= 0.0 && (period == 0 || savedDifficultyElapsed < period))) {
+        return false;
+    }
+
+    ObstacleStore savedObstacles;
+    if (!savedObstacles.load(in, Star + 1)) return false;
+
+    WorldParams savedWorld;
+    savedWorld.width = worldWidth;
+    savedWorld.activeWidth = activeWidth;
+    setWorldParams(savedWorld);
+    applyWorldGeometry();
+
+    seed = savedSeed;
+    rng.setState(rngState);
+    timeMs = savedTime;
+    spawnElapsedMs = savedSpawnElapsed;
+    difficultyElapsedMs = savedDifficultyElapsed;
+    playerX = savedX;
+    previousPlayerX = savedPreviousX;
+    lives = savedLives;
+    score = savedScore;
+    gameOver = savedGameOver;
+    difficulty.spawnIntervalMs = interval;
+    difficulty.spawnCount = count;
+    difficulty.maxSpawnCount = maxCount;
+    difficulty.minSpawnIntervalMs = minInterval;
+    difficulty.periodMs = period;
+    difficulty.speedFactorStep = speedStep;
+    difficulty.spawnIntervalFactor = intervalFactor;
+    obstacleSpeedFactor = savedSpeedFactor;
+    spawnIntervalMs = savedSpawnInterval;
+    spawnCount = savedSpawnCount;
+    // Обмен, а не копирование: буферы текущего хранилища уйдут во временный объект
+    std::swap(obstacles, savedObstacles);
+
+    eventQueue.resize(0);
+    collisionStats = CollisionStats();
+    return true;
+}
+
+quint64 GameSimulation::stateHash() const
+{
+    quint64 hash = 14695981039346656037ULL;
+    hashValue(hash, timeMs);
+    hashValue(hash, playerX);
+    hashValue(hash, lives);
+    hashValue(hash, score);
+    hashValue(hash, gameOver);
+    hashValue(hash, obstacleSpeedFactor);
+    hashValue(hash, spawnIntervalMs);
+    hashValue(hash, spawnCount);
+    hashValue(hash, rng.getState());
+    for (int slot = 0; slot < obstacles.slotCount(); ++slot) {
+        if (!obstacles.isAlive(slot)) continue;
+        hashValue(hash, slot);
+        hashValue(hash, obstacles.type(slot));
+        hashValue(hash, obstacles.x(slot));
+        hashValue(hash, obstacles.y(slot));
+        hashValue(hash, obstacles.speed(slot));
+    }
+    return hash;
+}
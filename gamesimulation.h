@@ -0,0 +1,218 @@
+#ifndef GAMESIMULATION_H
+#define GAMESIMULATION_H
+
+#include <QPoint>
+#include <QByteArray>
+#include <QVector>
+#include "obstaclestore.h"
+#include "collisiongrid.h"
+#include "collisionmask.h"
+#include "gamerng.h"
+#include "profiler.h"
+
+// Ввод игрока на один шаг симуляции
+struct SimInput {
+    int direction = 0; // -1 влево, 0 на месте, 1 вправо
+};
+
+// Событие, произошедшее во время шага; представление (Game) по ним
+// обновляет спрайты и интерфейс
+struct SimEvent {
+    enum Kind {
+        Spawned,             // появилось препятствие в слоте slot
+        Missed,              // препятствие покинуло поле (+10, кроме звезды)
+        StarCollected,       // +50 очков
+        HeartCollected,      // +1 жизнь
+        HeartConverted,      // жизни на максимуме: +25 очков вместо сердца
+        Hit,                 // столкновение с камнем или бомбой: -1 жизнь
+        DifficultyIncreased,
+        GameOver
+    };
+
+    Kind kind;
+    int slot = -1;
+    int type = 0;
+    float x = 0.0f; // центр препятствия для столкновений и подборов (эффекты)
+    float y = 0.0f;
+};
+
+// Параметры спавна и роста сложности
+struct DifficultyParams {
+    int spawnIntervalMs = 800;        // начальный интервал между волнами
+    int spawnCount = 1;               // начальное число препятствий в волне
+    int maxSpawnCount = 5;
+    int minSpawnIntervalMs = 150;
+    int periodMs = 20000;             // период роста сложности; 0 — не растёт
+    double speedFactorStep = 1.15;
+    double spawnIntervalFactor = 0.90;
+};
+
+// Размеры мира. Мир шире экрана только по горизонтали: по высоте он
+// всегда один экран (FieldHeight). Спавн и широкая фаза столкновений
+// ограничены активной областью шириной activeWidth вокруг игрока (у края
+// мира — прижатой к краю), поэтому цена шага не зависит от ширины мира
+struct WorldParams {
+    int width = 800;
+    int activeWidth = 800;
+};
+
+// Счётчики проверки столкновений за последний шаг
+struct CollisionStats {
+    int candidatePairs = 0; // пары игрок-препятствие, выданные широкой фазой
+    int narrowTests = 0;    // попиксельные проверки выборок на заметённом отрезке
+};
+
+// Игровые правила без отображения: спавн, сложность, счёт, жизни,
+// столкновения и конец игры. Не требует виджетов, сцены, цикла событий
+// и таймеров — время задаётся параметром step(), поэтому симуляцию можно
+// гонять в тестах и пакетных инструментах с любой скоростью.
+class GameSimulation
+{
+public:
+    // Базовый такт, к которому привязаны скорости (пикселей за такт)
+    static constexpr double TickMs = 16.0;
+
+    // Один экран: размер окна и мира по умолчанию
+    static constexpr int FieldWidth = 800;
+    static constexpr int FieldHeight = 600;
+    static constexpr int PlayerSize = 60;
+    static constexpr int ObstacleSize = 50;
+    static constexpr int PlayerY = 500;
+    static constexpr int StartLives = 3;
+    static constexpr int MaxLives = 5;
+
+    // Типы препятствий; значения совпадают с Obstacle::ObstacleType
+    enum ObstacleKind { Rock = 1, Bomb = 2, Heart = 3, Star = 4 };
+
+    GameSimulation();
+
+    // Маски столкновений, индексированные как SpriteCache: 0 — игрок, 1..4 — препятствия.
+    // Без масок попаданием считается пересечение AABB.
+    void setCollisionMasks(const QVector<CollisionMask> &spriteMasks);
+
+    // Параметры сложности применяются при следующем reset()
+    void setDifficultyParams(const DifficultyParams &params) { difficulty = params; }
+    const DifficultyParams &getDifficultyParams() const { return difficulty; }
+
+    // Размеры мира применяются при следующем reset(); слишком малые
+    // значения поднимаются до минимально играбельных
+    void setWorldParams(const WorldParams &params);
+    const WorldParams &getWorldParams() const { return world; }
+
+    // Без потери жизней (бенчмарки, автотесты): столкновения по-прежнему
+    // обрабатываются и порождают события
+    void setInvulnerable(bool enabled) { invulnerable = enabled; }
+
+    // Необязательный профилировщик участков шага (спавн, движение, столкновения)
+    void setProfiler(Profiler *stepProfiler) { profiler = stepProfiler; }
+
+    // Начинает новую сессию; все случайные решения определяются seed
+    void reset(quint64 seed);
+
+    // Продвигает симуляцию на dtMs миллисекунд.
+    // Список events() очищается в начале каждого шага.
+    void step(double dtMs, const SimInput &input);
+
+    void spawnObject(int type);
+    void removeAllObjects();
+
+    bool isGameOver() const { return gameOver; }
+    int getScore() const { return score; }
+    int getLives() const { return lives; }
+    double getPlayerX() const { return playerX; }
+    double getPreviousPlayerX() const { return previousPlayerX; }
+    double getPlayerY() const { return PlayerY; }
+    // Левый край активной области вокруг игрока
+    double getActiveLeft() const;
+    double getTimeMs() const { return timeMs; }
+    // Время в базовых тактах — шкала траекторий ObstacleStore
+    double getTimeTicks() const { return timeMs / TickMs; }
+    quint64 getSeed() const { return seed; }
+    // Новый генератор спавна: меняются только будущие волны, seed сессии
+    // и текущее состояние остаются. Так бот перебирает возможные будущие,
+    // не зная настоящего
+    void reseedSpawns(quint64 spawnSeed) { rng.reseed(spawnSeed); }
+
+    // Хэш полного состояния для проверки побитового совпадения при воспроизведении
+    quint64 stateHash() const;
+
+    // Двоичный снимок сессии: игрок, счёт, жизни, время, параметры и текущее
+    // состояние сложности, состояние ГСЧ и все препятствия. Маски, профилировщик
+    // и неуязвимость — настройки, а не состояние, и в снимок не входят.
+    // Перегрузка с буфером переиспользует его память (кольцо перемотки).
+    QByteArray saveState() const;
+    void saveState(QByteArray &buffer) const;
+    // Повреждённый или чужой снимок (в том числе со значениями вне диапазонов
+    // игры) отвергается, текущее состояние не меняется
+    bool restoreState(const QByteArray &buffer);
+
+    double getSpeedFactor() const { return obstacleSpeedFactor; }
+    int getSpawnIntervalMs() const { return spawnIntervalMs; }
+    int getSpawnCount() const { return spawnCount; }
+
+    const ObstacleStore &getObstacles() const { return obstacles; }
+    const QVector<SimEvent> &events() const { return eventQueue; }
+    void clearEvents() { eventQueue.resize(0); }
+    // Пишет события последнего шага в Trace (если трасса включена).
+    // Вызывает владелец сессии, а не step(): копии симуляции в поиске
+    // бота не должны засорять трассу
+    void traceEvents() const;
+    const CollisionStats &getCollisionStats() const { return collisionStats; }
+
+private:
+    // Сетка под текущую ширину активной области
+    void applyWorldGeometry();
+    void movePlayer(double ticks, int direction);
+    void expireObstacles();
+    void checkCollisions(double ticks);
+    void handleHit(int slot);
+    void spawnWave();
+    void increaseDifficulty();
+    void pushEvent(SimEvent::Kind kind, int slot = -1, int type = 0, float x = 0.0f, float y = 0.0f);
+
+    ObstacleStore obstacles;
+    QVector<CollisionMask> masks;
+    GameRng rng;
+    quint64 seed = 0;
+    Profiler *profiler = nullptr;
+    QVector<SimEvent> eventQueue;
+
+    // Широкая фаза: сетка покрывает и зону спавна над экраном,
+    // покрывает активную область и сдвигается вместе с ней
+    CollisionGrid collisionGrid{QRectF(0, -256, FieldWidth, FieldHeight + 360), 64};
+    CollisionStats collisionStats;
+
+    // Рабочие буферы, переиспользуемые между шагами
+    QVector<int> missedSlots;
+    QVector<int> candidateSlots;
+    QVector<int> narrowSlots;
+    QVector<quint8> candidateHits;
+    // Выборки узкой фазы: кандидат-владелец, маска и положение относительно игрока
+    QVector<int> narrowOwners;
+    QVector<const CollisionMask*> narrowMasks;
+    QVector<QPoint> narrowPositions;
+    QVector<quint8> narrowHits;
+
+    // Мир, игрок и счёт
+    WorldParams world;
+    double playerX = (FieldWidth - PlayerSize) / 2.0;
+    double previousPlayerX = playerX;
+    double playerSpeed = 8;
+    int lives = StartLives;
+    int score = 0;
+    bool gameOver = false;
+
+    // Время симуляции и накопители периодических событий
+    double timeMs = 0.0;
+    double spawnElapsedMs = 0.0;
+    double difficultyElapsedMs = 0.0;
+
+    // Параметры сложности и текущее состояние спавна
+    DifficultyParams difficulty;
+    bool invulnerable = false;
+    double obstacleSpeedFactor = 1.0;
+    int spawnIntervalMs = 800;
+    int spawnCount = 1;
+};
+
+#endif // GAMESIMULATION_H
@@ -0,0 +1,89 @@
+#include "huditem.h"
+#include "gamesimulation.h"
+#include <QFontMetricsF>
+#include <QPainter>
+
+namespace {
+// Смещения строк совпадают с прежними QGraphicsTextItem (поле документа 4 px)
+const QPointF ScorePos(4, 4);
+const QPointF LivesPos(4, 34);
+}
+
+HudItem::HudItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent), font("Arial", 16, QFont::Bold)
+{
+    scoreLabel.setText(QStringLiteral("Очки: "));
+    livesLabel.setText(QStringLiteral("Жизни: "));
+    for (QStaticText *text : { &scoreLabel, &livesLabel, &scoreValue, &livesValue }) {
+        text->setTextFormat(Qt::PlainText);
+        text->setPerformanceHint(QStaticText::AggressiveCaching);
+    }
+    scoreLabel.prepare(QTransform(), font);
+    livesLabel.prepare(QTransform(), font);
+
+    // Числа выравниваются по самой длинной подписи; ширина рассчитана на
+    // десятизначный счёт, поэтому прямоугольник не меняется во время игры
+    const QFontMetricsF metrics(font);
+    valueOffset = qMax(scoreLabel.size().width(), livesLabel.size().width());
+    bounds = QRectF(0, 0, ScorePos.x() + valueOffset + metrics.horizontalAdvance(QString(10, QLatin1Char('0'))),
+                    LivesPos.y() + metrics.height() + 4);
+
+    setZValue(90);
+    lives = GameSimulation::StartLives;
+    flush();
+}
+
+void HudItem::setScore(int value)
+{
+    if (value == score) return;
+    score = value;
+    scoreDirty = true;
+}
+
+void HudItem::setLives(int value)
+{
+    if (value == lives) return;
+    lives = value;
+    livesDirty = true;
+}
+
+void HudItem::flush()
+{
+    if (!isDirty()) return;
+
+    if (scoreDirty) {
+        scoreValue.setText(QString::number(score));
+        scoreValue.prepare(QTransform(), font);
+        ++relayoutCount;
+    }
+    if (livesDirty) {
+        livesValue.setText(QString::number(lives));
+        livesValue.prepare(QTransform(), font);
+        livesLow = lives == 1;
+        ++relayoutCount;
+    }
+    scoreDirty = false;
+    livesDirty = false;
+    update();
+}
+
+QRectF HudItem::boundingRect() const
+{
+    return bounds;
+}
+
+void HudItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    painter->setFont(font);
+
+    painter->setPen(Qt::blue);
+    painter->drawStaticText(ScorePos, scoreLabel);
+    painter->drawStaticText(ScorePos + QPointF(valueOffset, 0), scoreValue);
+
+    painter->setPen(livesLow ? Qt::red : Qt::green);
+    painter->drawStaticText(LivesPos, livesLabel);
+    painter->drawStaticText(LivesPos + QPointF(valueOffset, 0), livesValue);
+}
@@ -0,0 +1,50 @@
+#ifndef HUDITEM_H
+#define HUDITEM_H
+
+#include <QGraphicsItem>
+#include <QStaticText>
+#include <QFont>
+
+// Счёт и жизни поверх сцены.
+// Значения только запоминаются и помечаются изменёнными; раскладка текста
+// пересчитывается в flush() не чаще раза за кадр и лишь для изменившихся
+// строк. Рисуется через QStaticText — глифы раскладываются один раз,
+// без QTextDocument, как у QGraphicsTextItem.
+class HudItem : public QGraphicsItem
+{
+public:
+    explicit HudItem(QGraphicsItem *parent = nullptr);
+
+    void setScore(int value);
+    void setLives(int value);
+
+    bool isDirty() const { return scoreDirty || livesDirty; }
+
+    // Применяет изменения с прошлого вызова; вызывается раз за кадр
+    void flush();
+
+    // Сколько раз пересчитывалась раскладка строк
+    quint64 relayouts() const { return relayoutCount; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    QFont font;
+    QRectF bounds;
+
+    QStaticText scoreLabel;
+    QStaticText livesLabel;
+    QStaticText scoreValue;
+    QStaticText livesValue;
+    qreal valueOffset = 0;
+
+    int score = 0;
+    int lives = 0;
+    bool scoreDirty = true;
+    bool livesDirty = true;
+    bool livesLow = false;
+    quint64 relayoutCount = 0;
+};
+
+#endif // HUDITEM_H
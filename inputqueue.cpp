@@ -0,0 +1,70 @@
+#include "inputqueue.h"
+#include "profiler.h"
+
+namespace {
+// Верхние границы интервалов гистограммы, мс; последний — всё, что больше
+const double BucketLimitsMs[] = { 4, 8, 16, 24, 33, 50, 100 };
+}
+
+quint32 InputQueue::push(InputEvent::Type type, int key, qint64 timeNs, bool measured)
+{
+    // Прочитанные команды вытесняются, как только очередь опустеет
+    if (next > 0 && next == queued.size()) {
+        queued.resize(0);
+        next = 0;
+    }
+
+    InputCommand command;
+    command.sequence = ++lastSequence;
+    command.timeNs = timeNs;
+    command.type = type;
+    command.key = key;
+    queued.append(command);
+    if (!measured) return command.sequence;
+
+    if (awaiting.size() >= MaxAwaiting) {
+        // Кадры не показываются (окно свёрнуто) — старые замеры не нужны
+        awaiting.erase(awaiting.begin());
+    }
+    awaiting.append(command);
+    return command.sequence;
+}
+
+bool InputQueue::pop(InputCommand &command)
+{
+    if (isEmpty()) return false;
+    command = queued[next++];
+    return true;
+}
+
+void InputQueue::presented(quint32 sequence, qint64 nowNs, Profiler &profiler)
+{
+    int done = 0;
+    while (done < awaiting.size() && awaiting[done].sequence <= sequence) {
+        const qint64 latencyNs = nowNs - awaiting[done].timeNs;
+        profiler.addSample(Profiler::InputLatency, latencyNs);
+
+        const double latencyMs = latencyNs / 1e6;
+        int bucket = 0;
+        while (bucket < BucketCount - 1 && latencyMs >= BucketLimitsMs[bucket]) {
+            ++bucket;
+        }
+        ++buckets[bucket];
+        ++done;
+    }
+    if (done > 0) {
+        awaiting.erase(awaiting.begin(), awaiting.begin() + done);
+    }
+}
+
+QString InputQueue::histogramText() const
+{
+    QString text = QStringLiteral("input ms:");
+    for (int i = 0; i < BucketCount; ++i) {
+        const QString label = i < BucketCount - 1
+            ? QStringLiteral("<%1").arg(BucketLimitsMs[i])
+            : QStringLiteral(">=%1").arg(BucketLimitsMs[BucketCount - 2]);
+        text += QStringLiteral(" %1:%2").arg(label).arg(buckets[i]);
+    }
+    return text;
+}
@@ -0,0 +1,56 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <QString>
+#include <QVector>
+#include "inputrecording.h"
+
+class Profiler;
+
+// Команда ввода с моментом её получения
+struct InputCommand {
+    quint32 sequence = 0;   // сквозной номер, начиная с 1
+    qint64 timeNs = 0;
+    InputEvent::Type type = InputEvent::KeyPress;
+    int key = 0;
+};
+
+// Единый путь ввода игрока. Обработчики клавиш только ставят команды
+// в очередь с отметкой времени; применяются они в начале шага симуляции,
+// поэтому движение начинается в определённый момент, а не между шагами.
+// Очередь также помнит команды до первого показанного кадра, в котором
+// учтён их результат, и собирает задержку «клавиша → кадр».
+class InputQueue
+{
+public:
+    // Ставит команду в очередь и возвращает её номер. При measured == false
+    // задержка команды не замеряется (игра на паузе или остановлена: время
+    // до следующего кадра — это длительность паузы, а не задержка ввода)
+    quint32 push(InputEvent::Type type, int key, qint64 timeNs, bool measured = true);
+    bool pop(InputCommand &command);
+    bool isEmpty() const { return next == queued.size(); }
+
+    // Забывает команды, ожидающие показа (игра остановлена — кадра с их
+    // результатом не будет). Неприменённые команды остаются в очереди:
+    // потерянное отпускание клавиши оставило бы игрока в движении
+    void clearAwaiting() { awaiting.resize(0); }
+
+    // Показан кадр, учитывающий команды до sequence включительно: их
+    // задержка уходит в секцию InputLatency профилировщика и в гистограмму
+    void presented(quint32 sequence, qint64 nowNs, Profiler &profiler);
+
+    // Гистограмма задержек по интервалам, мс, одной строкой для оверлея
+    QString histogramText() const;
+
+private:
+    static constexpr int MaxAwaiting = 256;
+    static constexpr int BucketCount = 8;
+
+    QVector<InputCommand> queued;
+    int next = 0;
+    QVector<InputCommand> awaiting;
+    quint32 lastSequence = 0;
+    quint64 buckets[BucketCount] = {};
+};
+
+#endif // INPUTQUEUE_H
@@ -0,0 +1,158 @@
+#include "inputrecording.h"
+#include "gamesimulation.h"
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+
+namespace {
+const quint32 RecordingMagic = 0x46475250; // "FGRP"
+const quint16 RecordingVersion = 1;
+// Размеры в потоке QDataStream: заголовок (magic, version, seed, count) и событие
+const qint64 HeaderSize = 4 + 2 + 8 + 4;
+const qint64 EventSize = 4 + 1 + 8;
+}
+
+void KeyDirection::press(int key)
+{
+    if (key == Qt::Key_Left) {
+        dir = -1;
+        leftHeld = true;
+    } else if (key == Qt::Key_Right) {
+        dir = 1;
+        rightHeld = true;
+    }
+}
+
+void KeyDirection::release(int key)
+{
+    if (key == Qt::Key_Left) {
+        leftHeld = false;
+        if (dir == -1) dir = 0;
+    } else if (key == Qt::Key_Right) {
+        rightHeld = false;
+        if (dir == 1) dir = 0;
+    }
+}
+
+bool KeyDirection::isPressed(int key) const
+{
+    if (key == Qt::Key_Left) return leftHeld;
+    if (key == Qt::Key_Right) return rightHeld;
+    return false;
+}
+
+void InputRecording::start(quint64 sessionSeed)
+{
+    seed = sessionSeed;
+    events.resize(0);
+}
+
+void InputRecording::append(quint32 tick, InputEvent::Type type, quint64 value)
+{
+    InputEvent event;
+    event.tick = tick;
+    event.type = type;
+    event.value = value;
+    events.append(event);
+}
+
+bool InputRecording::save(const QString &path, quint32 endTick) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << RecordingMagic << RecordingVersion << seed << quint32(events.size() + 1);
+    for (const InputEvent &event : events) {
+        out << event.tick << event.type << event.value;
+    }
+    out << endTick << quint8(InputEvent::End) << quint64(0);
+    return out.status() == QDataStream::Ok;
+}
+
+bool InputRecording::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> seed >> count;
+    if (magic != RecordingMagic || version != RecordingVersion) return false;
+    // Число событий из файла не может превышать его размер: испорченная
+    // запись не должна приводить к выделению гигабайт
+    if (in.status() != QDataStream::Ok || count > static_cast<quint64>((file.size() - HeaderSize) / EventSize)) {
+        return false;
+    }
+
+    events.resize(0);
+    events.reserve(static_cast<int>(count));
+    for (quint32 i = 0; i < count; ++i) {
+        InputEvent event;
+        in >> event.tick >> event.type >> event.value;
+        if (in.status() != QDataStream::Ok || event.type > InputEvent::End) {
+            events.resize(0);
+            return false;
+        }
+        events.append(event);
+    }
+    return true;
+}
+
+ReplayResult InputRecording::replayHeadless(const QVector<CollisionMask> &masks) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    GameSimulation simulation;
+    simulation.setCollisionMasks(masks);
+    simulation.reset(seed);
+
+    KeyDirection keys;
+    quint32 tick = 0;
+    int cursor = 0;
+    bool ended = false;
+
+    while (!ended) {
+        // События применяются перед шагом с тем же номером, как в Game::tick()
+        while (cursor < events.size() && events[cursor].tick <= tick) {
+            const InputEvent &event = events[cursor++];
+            switch (event.type) {
+            case InputEvent::KeyPress:
+                keys.press(static_cast<int>(event.value));
+                break;
+            case InputEvent::KeyRelease:
+                keys.release(static_cast<int>(event.value));
+                break;
+            case InputEvent::Reset:
+                simulation.reset(event.value);
+                keys = KeyDirection();
+                break;
+            case InputEvent::End:
+                ended = true;
+                break;
+            }
+        }
+
+        // Пока игра окончена, шаги не идут; новых событий на этом шаге больше нет
+        if (ended || simulation.isGameOver()) break;
+
+        SimInput input;
+        input.direction = keys.direction();
+        simulation.step(GameSimulation::TickMs, input);
+        ++tick;
+    }
+
+    ReplayResult result;
+    result.ticks = tick;
+    result.score = simulation.getScore();
+    result.lives = simulation.getLives();
+    result.stateHash = simulation.stateHash();
+    result.elapsedMs = timer.nsecsElapsed() / 1e6;
+    return result;
+}
@@ -0,0 +1,73 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <QString>
+#include <QVector>
+#include "collisionmask.h"
+
+// Событие записи ввода
+struct InputEvent {
+    enum Type : quint8 {
+        KeyPress = 0,   // value — код клавиши Qt::Key
+        KeyRelease = 1,
+        Reset = 2,      // новая сессия; value — её seed
+        End = 3         // конец записи
+    };
+
+    quint32 tick = 0;   // номер шага симуляции, перед которым применяется событие
+    quint8 type = KeyPress;
+    quint64 value = 0;
+};
+
+// Направление движения игрока по нажатым клавишам ← →.
+// Общая логика для Game и воспроизведения без отображения.
+// Направление задаёт последнее нажатие; кроме него хранится, какие
+// клавиши зажаты, — направление 0 не значит, что отпущены обе
+class KeyDirection
+{
+public:
+    void press(int key);
+    void release(int key);
+    int direction() const { return dir; }
+    bool isPressed(int key) const;
+
+private:
+    int dir = 0;
+    bool leftHeld = false;
+    bool rightHeld = false;
+};
+
+// Итог воспроизведения записи
+struct ReplayResult {
+    quint32 ticks = 0;
+    int score = 0;
+    int lives = 0;
+    quint64 stateHash = 0;
+    double elapsedMs = 0.0;
+};
+
+// Компактная запись сессии: seed и журнал клавиш с номерами шагов.
+// Поскольку симуляция детерминирована, этого достаточно, чтобы
+// повторить игру побитово.
+class InputRecording
+{
+public:
+    void start(quint64 seed);
+    void append(quint32 tick, InputEvent::Type type, quint64 value = 0);
+
+    quint64 getSeed() const { return seed; }
+    const QVector<InputEvent> &getEvents() const { return events; }
+
+    // Сохраняет запись, завершая её событием End на шаге endTick
+    bool save(const QString &path, quint32 endTick) const;
+    bool load(const QString &path);
+
+    // Прогоняет запись через GameSimulation без отображения и таймеров
+    ReplayResult replayHeadless(const QVector<CollisionMask> &masks) const;
+
+private:
+    quint64 seed = 0;
+    QVector<InputEvent> events;
+};
+
+#endif // INPUTRECORDING_H
@@ -1,13 +1,311 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QScreen>
+#include "benchmark.h"
+#include "difficultytuner.h"
 #include "game.h"
+#include "inputrecording.h"
+#include "spritecache.h"
+#include "trace.h"
+
+namespace {
+// Qt::SkipEmptyParts появился в 5.14, QString::SkipEmptyParts устарел в 5.15
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+const auto SkipEmpty = Qt::SkipEmptyParts;
+#else
+const auto SkipEmpty = QString::SkipEmptyParts;
+#endif
+
+// Список значений через запятую; при ошибке разбора или значении вне
+// допустимого диапазона (valid) список остаётся прежним
+template <typename T, typename Convert, typename Valid>
+bool parseList(const QString &text, QVector<T> &values, Convert convert, Valid valid)
+{
+    QVector<T> parsed;
+    for (const QString &part : text.split(',', SkipEmpty)) {
+        bool ok = false;
+        const T value = convert(part.trimmed(), &ok);
+        if (!ok || !valid(value)) return false;
+        parsed.append(value);
+    }
+    if (parsed.isEmpty()) return false;
+    values = parsed;
+    return true;
+}
+
+// Множители сложности: только конечные положительные
+bool parseFactors(const QString &text, QVector<double> &values)
+{
+    return parseList(text, values, [](const QString &s, bool *ok) { return s.toDouble(ok); },
+                     [](double value) { return qIsFinite(value) && value > 0.0; });
+}
+
+bool parseInts(const QString &text, QVector<int> &values, int minimum)
+{
+    return parseList(text, values, [](const QString &s, bool *ok) { return s.toInt(ok); },
+                     [minimum](int value) { return value >= minimum; });
+}
+
+// Сохраняет трассу при любом выходе из main(), в том числе после --bench и --tune
+struct TraceDump {
+    QString path;
+    ~TraceDump()
+    {
+        if (!path.isEmpty() && !Trace::writeChromeJson(path)) {
+            qWarning() << "Не удалось сохранить трассу в" << path;
+        }
+    }
+};
+}
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Face Game");
+    parser.addHelpOption();
+    QCommandLineOption seedOption("seed", "Seed первой игровой сессии.", "seed");
+    QCommandLineOption recordOption("record", "Записать ввод сессии в файл.", "file");
+    QCommandLineOption replayOption("replay", "Воспроизвести запись из файла.", "file");
+    QCommandLineOption headlessOption("headless",
+        "Воспроизвести запись без окна и таймеров с максимальной скоростью "
+        "(вместе с --replay; удобно запускать с -platform offscreen).");
+    QCommandLineOption renderIntervalOption("render-interval",
+        "Интервал отрисовки в мс; скорость игры от него не зависит.", "ms", "8");
+    QCommandLineOption benchOption("bench",
+        "Нагрузочный прогон фиксированной длины с выводом JSON "
+        "(для рендеринга без окна запускать с -platform offscreen).");
+    QCommandLineOption checkMasksOption("check-masks",
+        "Сверить узкую фазу по маскам с QGraphicsItem::collidesWithItem() на всех "
+        "смещениях спрайтов; JSON-отчёт, код возврата 1 при расхождении.");
+    QCommandLineOption ticksOption("ticks", "Число измеряемых тактов (--bench).", "n", "10000");
+    QCommandLineOption obstaclesOption("obstacles", "Поддерживать не меньше n препятствий (--bench).", "n", "0");
+    QCommandLineOption particlesOption("particles", "Поддерживать не меньше n частиц (--bench --render).", "n", "0");
+    QCommandLineOption spawnIntervalOption("spawn-interval", "Интервал между волнами, мс (--bench).", "ms", "800");
+    QCommandLineOption spawnCountOption("spawn-count", "Препятствий в волне (--bench).", "n", "1");
+    QCommandLineOption noDifficultyOption("no-difficulty", "Не повышать сложность (--bench).");
+    QCommandLineOption renderOption("render", "Рисовать сцену каждый такт (--bench).");
+    QCommandLineOption rendererOption("renderer",
+        "Способ отрисовки: scene — элементы QGraphicsScene, direct — прямой вывод "
+        "из состояния симуляции одним пакетом по атласу.", "scene|direct", "scene");
+    QCommandLineOption tuneOption("tune",
+        "Подбор констант сложности: пакет сессий без отображения на всех ядрах, "
+        "распределения времени жизни и счёта в JSON.");
+    QCommandLineOption runsOption("runs", "Сессий на точку сетки (--tune).", "n", "200");
+    QCommandLineOption maxTicksOption("max-ticks", "Предел длины сессии в тактах (--tune).", "n", "36000");
+    QCommandLineOption policyOption("policy", "Игрок (--tune): scripted, random или autopilot.", "policy", "random");
+    QCommandLineOption autopilotOption("autopilot", "Играет бот с поиском вперёд (переключается клавишей A).");
+    QCommandLineOption threadsOption("threads", "Число потоков (--tune), 0 — по числу ядер.", "n", "0");
+    QCommandLineOption speedStepsOption("speed-steps", "Значения speedFactorStep через запятую (--tune).", "list");
+    QCommandLineOption intervalFactorsOption("interval-factors", "Значения spawnIntervalFactor (--tune).", "list");
+    QCommandLineOption maxSpawnCountsOption("max-spawn-counts", "Значения maxSpawnCount (--tune).", "list");
+    QCommandLineOption minIntervalsOption("min-intervals", "Значения minSpawnIntervalMs (--tune).", "list");
+    QCommandLineOption periodsOption("periods", "Значения периода роста сложности, мс (--tune).", "list");
+    QCommandLineOption singleThreadOption("single-thread",
+        "Выполнять симуляцию в потоке GUI (запись и воспроизведение всегда так).");
+    QCommandLineOption traceOption("trace",
+        "Записывать трассу событий и сохранить её при выходе (Chrome Trace JSON). "
+        "В игре трасса пишется всегда, F2 сохраняет её в trace-<время>.json.", "file");
+    QCommandLineOption worldWidthOption("world-width",
+        "Ширина мира в пикселях; камера следует за игроком (игра и --bench).", "px", "800");
+    QCommandLineOption outputOption("output", "Файл для JSON-отчёта (--bench, --check-masks), по умолчанию stdout.", "file");
+    parser.addOption(seedOption);
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(headlessOption);
+    parser.addOption(renderIntervalOption);
+    parser.addOption(benchOption);
+    parser.addOption(checkMasksOption);
+    parser.addOption(ticksOption);
+    parser.addOption(obstaclesOption);
+    parser.addOption(particlesOption);
+    parser.addOption(spawnIntervalOption);
+    parser.addOption(spawnCountOption);
+    parser.addOption(noDifficultyOption);
+    parser.addOption(renderOption);
+    parser.addOption(rendererOption);
+    parser.addOption(tuneOption);
+    parser.addOption(runsOption);
+    parser.addOption(maxTicksOption);
+    parser.addOption(policyOption);
+    parser.addOption(autopilotOption);
+    parser.addOption(threadsOption);
+    parser.addOption(speedStepsOption);
+    parser.addOption(intervalFactorsOption);
+    parser.addOption(maxSpawnCountsOption);
+    parser.addOption(minIntervalsOption);
+    parser.addOption(periodsOption);
+    parser.addOption(singleThreadOption);
+    parser.addOption(worldWidthOption);
+    parser.addOption(outputOption);
+    parser.addOption(traceOption);
+    parser.process(a);
+
+    Trace::setThreadName("gui");
+    TraceDump traceDump{parser.value(traceOption)};
+    Trace::setEnabled(!traceDump.path.isEmpty());
+
+    const QString renderer = parser.value(rendererOption);
+    if (renderer != "scene" && renderer != "direct") {
+        qCritical() << "Неизвестный способ отрисовки" << renderer;
+        return 1;
+    }
+    const bool directRender = renderer == "direct";
+
+    // Активная область (спавн, широкая фаза) остаётся шириной в экран,
+    // высота мира — всегда один экран
+    WorldParams world;
+    world.width = parser.value(worldWidthOption).toInt();
+    const bool customWorld = parser.isSet(worldWidthOption);
+
+    if (parser.isSet(checkMasksOption)) {
+        const QJsonObject report = Benchmark::checkCollisionMasks();
+        if (!Benchmark::write(report, parser.value(outputOption))) {
+            qCritical() << "Не удалось записать отчёт" << parser.value(outputOption);
+            return 1;
+        }
+        return report["mismatches"].toInt() == 0 ? 0 : 1;
+    }
+
+    if (parser.isSet(benchOption)) {
+        BenchmarkConfig config;
+        config.ticks = qMax(1, parser.value(ticksOption).toInt());
+        config.obstacles = qMax(0, parser.value(obstaclesOption).toInt());
+        config.particles = qMax(0, parser.value(particlesOption).toInt());
+        config.difficulty.spawnIntervalMs = qMax(1, parser.value(spawnIntervalOption).toInt());
+        config.difficulty.spawnCount = qMax(0, parser.value(spawnCountOption).toInt());
+        config.difficulty.maxSpawnCount = qMax(config.difficulty.maxSpawnCount, config.difficulty.spawnCount);
+        if (parser.isSet(noDifficultyOption)) {
+            config.difficulty.periodMs = 0;
+        }
+        config.world = world;
+        config.render = parser.isSet(renderOption);
+        config.directRender = directRender;
+        if (parser.isSet(seedOption)) {
+            config.seed = parser.value(seedOption).toULongLong();
+        }
+        config.outputPath = parser.value(outputOption);
+
+        const QJsonObject report = Benchmark::run(config);
+        if (!Benchmark::write(report, config.outputPath)) {
+            qCritical() << "Не удалось записать отчёт" << config.outputPath;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (parser.isSet(tuneOption)) {
+        TunerConfig config;
+        config.runs = qMax(1, parser.value(runsOption).toInt());
+        config.maxTicks = qMax(1, parser.value(maxTicksOption).toInt());
+        config.threads = parser.value(threadsOption).toInt();
+        if (parser.isSet(seedOption)) {
+            config.seed = parser.value(seedOption).toULongLong();
+        }
+        config.outputPath = parser.value(outputOption);
+
+        bool ok = DifficultyTuner::parsePolicy(parser.value(policyOption), config.policy);
+        if (ok && parser.isSet(speedStepsOption)) {
+            ok = parseFactors(parser.value(speedStepsOption), config.speedFactorSteps);
+        }
+        if (ok && parser.isSet(intervalFactorsOption)) {
+            ok = parseFactors(parser.value(intervalFactorsOption), config.spawnIntervalFactors);
+        }
+        if (ok && parser.isSet(maxSpawnCountsOption)) {
+            ok = parseInts(parser.value(maxSpawnCountsOption), config.maxSpawnCounts, 1);
+        }
+        if (ok && parser.isSet(minIntervalsOption)) {
+            ok = parseInts(parser.value(minIntervalsOption), config.minSpawnIntervalsMs, 1);
+        }
+        if (ok && parser.isSet(periodsOption)) {
+            // Период 0 выключает рост сложности
+            ok = parseInts(parser.value(periodsOption), config.periodsMs, 0);
+        }
+        if (!ok) {
+            qCritical() << "Неверные параметры подбора сложности";
+            return 1;
+        }
+
+        const QJsonObject report = DifficultyTuner::run(config);
+        if (!Benchmark::write(report, config.outputPath)) {
+            qCritical() << "Не удалось записать отчёт" << config.outputPath;
+            return 1;
+        }
+        return 0;
+    }
+
+    InputRecording replayLog;
+    if (parser.isSet(replayOption)) {
+        if (!replayLog.load(parser.value(replayOption))) {
+            qCritical() << "Не удалось прочитать запись" << parser.value(replayOption);
+            return 1;
+        }
+
+        if (parser.isSet(headlessOption)) {
+            const ReplayResult result = replayLog.replayHeadless(SpriteCache::instance().collisionMasks());
+            const double simulatedMs = result.ticks * GameSimulation::TickMs;
+            qInfo().noquote() << "Replay finished: ticks=" << result.ticks
+                              << " score=" << result.score
+                              << " lives=" << result.lives
+                              << " hash=" << QString::number(result.stateHash, 16)
+                              << " elapsedMs=" << result.elapsedMs
+                              << " speedup=" << (result.elapsedMs > 0.0 ? simulatedMs / result.elapsedMs : 0.0);
+            return 0;
+        }
+    }
+
+    // В игре трасса пишется всегда: кольца хранят последние секунды,
+    // и подвисание можно выгрузить клавишей F2 сразу после него
+    Trace::setEnabled(true);
+
+    // Спрайты для всех подключённых экранов растеризуются до создания
+    // окна на потоках пула, в потоке GUI — только загрузка в QPixmap
+    QVector<qreal> ratios;
+    for (const QScreen *screen : QGuiApplication::screens()) {
+        ratios.append(screen->devicePixelRatio());
+    }
+    SpriteCache::instance().prepare(ratios);
+    const SpritePreparation &sprites = SpriteCache::instance().preparation();
+    qInfo().noquote() << "Sprites prepared: images=" << sprites.images
+                      << " threads=" << sprites.threads
+                      << " rasterMs=" << sprites.rasterMs
+                      << " uploadMs=" << sprites.uploadMs
+                      << " totalMs=" << sprites.totalMs;
+
     Game game;
+    game.setRenderIntervalMs(parser.value(renderIntervalOption).toInt());
+    game.setRenderBackend(directRender ? Game::DirectBackend : Game::SceneBackend);
+    if (customWorld) {
+        if (parser.isSet(replayOption) || parser.isSet(recordOption)) {
+            // Запись не хранит размеры мира и воспроизводится в мире по умолчанию
+            qWarning() << "Размеры мира не используются при записи и воспроизведении";
+        } else {
+            game.setWorldParams(world);
+        }
+    }
+    if (!parser.isSet(singleThreadOption) && !parser.isSet(replayOption) && !parser.isSet(recordOption)) {
+        game.setThreadedSimulation(true);
+    }
     game.show();
     game.setWindowTitle("Face Game - Управление стрелками ← →");
 
+    if (parser.isSet(autopilotOption)) {
+        game.setAutopilot(true);
+    }
+
+    if (parser.isSet(replayOption)) {
+        game.startReplay(replayLog);
+    } else {
+        if (parser.isSet(seedOption)) {
+            game.resetSession(parser.value(seedOption).toULongLong());
+            game.startGame();
+        }
+        if (parser.isSet(recordOption)) {
+            game.startRecording(parser.value(recordOption));
+        }
+    }
+
     return a.exec();
 }
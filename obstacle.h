@@ -2,7 +2,8 @@
 #define OBSTACLE_H
 
 #include "gameobject.h"
-#include <QTimer>
+
+class QPainter;
 
 class Obstacle : public GameObject
 {
@@ -10,33 +11,28 @@ class Obstacle : public GameObject
 
 public:
     enum ObstacleType { ROCK = 1, BOMB = 2, HEART = 3, STAR = 4 };
+    static constexpr int SpriteSize = 50;
+
+    // Рисует спрайт типа в квадрат SpriteSize x SpriteSize; используется SpriteCache
+    static void paintSprite(QPainter *painter, ObstacleType obstacleType);
 
     explicit Obstacle(ObstacleType type, QGraphicsItem *parent = nullptr);
 
     // Реализация чисто виртуальных методов из GameObject
     void update() override {}
-    void reset() override { stopFalling(); }
+    void reset() override;
     int getType() const override { return static_cast<int>(type); }
 
     ObstacleType getObstacleType() const;
-    void startFalling();
-    void stopFalling();
+    void setObstacleType(ObstacleType obstacleType) { type = obstacleType; }
     void safeRemove();
-    void multiplySpeed(double factor);
-
-signals:
-    void obstacleMissed(Obstacle *self);
-
-public slots:
-    void move();
 
 private:
     void handleCollision() override {}
-    QPixmap createPixmap(ObstacleType obstacleType);
 
+    // Состояние симуляции (позиция, скорость) хранится в ObstacleStore;
+    // объект только отображает спрайт в сцене
     ObstacleType type;
-    int speed;
-    QTimer *moveTimer;
 };
 
 #endif // OBSTACLE_H
@@ -0,0 +1,62 @@
+#include "obstaclepool.h"
+#include <QGraphicsScene>
+
+ObstaclePool::ObstaclePool(QGraphicsScene *scene, int capacity, QObject *parent)
+    : QObject(parent), scene(scene), maxFree(qMax(0, capacity))
+{
+    freeList.reserve(maxFree);
+}
+
+Obstacle *ObstaclePool::create(Obstacle::ObstacleType type)
+{
+    Obstacle *obstacle = new Obstacle(type);
+    ++allocationCount;
+    if (scene) {
+        scene->addItem(obstacle);
+    }
+    return obstacle;
+}
+
+Obstacle *ObstaclePool::acquire(Obstacle::ObstacleType type)
+{
+    if (freeList.isEmpty()) {
+        return create(type);
+    }
+
+    Obstacle *obstacle = freeList.takeLast();
+    obstacle->setObstacleType(type);
+    obstacle->reset();
+    return obstacle;
+}
+
+void ObstaclePool::release(Obstacle *obstacle)
+{
+    if (!obstacle) return;
+
+    if (freeList.size() >= maxFree) {
+        obstacle->safeRemove();
+        return;
+    }
+
+    obstacle->hide();
+    freeList.append(obstacle);
+}
+
+void ObstaclePool::prewarm(int count)
+{
+    count = qMin(count, maxFree);
+    while (freeList.size() < count) {
+        Obstacle *obstacle = create(Obstacle::ROCK);
+        obstacle->hide();
+        freeList.append(obstacle);
+    }
+}
+
+void ObstaclePool::setCapacity(int capacity)
+{
+    maxFree = qMax(0, capacity);
+    while (freeList.size() > maxFree) {
+        freeList.takeLast()->safeRemove();
+    }
+    freeList.reserve(maxFree);
+}
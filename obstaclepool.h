@@ -0,0 +1,42 @@
+#ifndef OBSTACLEPOOL_H
+#define OBSTACLEPOOL_H
+
+#include <QObject>
+#include <QVector>
+#include "obstacle.h"
+
+class QGraphicsScene;
+
+// Пул переиспользуемых препятствий.
+// Отыгравшие препятствия скрываются и возвращаются в список свободных,
+// новые берутся из него и переинициализируются через GameObject::reset().
+// Элементы остаются в сцене всё время жизни, поэтому в установившемся
+// режиме спавн ничего не выделяет.
+class ObstaclePool : public QObject
+{
+public:
+    explicit ObstaclePool(QGraphicsScene *scene, int capacity = 256, QObject *parent = nullptr);
+
+    Obstacle *acquire(Obstacle::ObstacleType type);
+    void release(Obstacle *obstacle);
+
+    // Заранее создаёт count свободных препятствий (не больше capacity)
+    void prewarm(int count);
+
+    // Максимальное число препятствий, хранимых в списке свободных
+    void setCapacity(int capacity);
+    int capacity() const { return maxFree; }
+
+    int freeCount() const { return freeList.size(); }
+    quint64 allocations() const { return allocationCount; }
+
+private:
+    Obstacle *create(Obstacle::ObstacleType type);
+
+    QGraphicsScene *scene = nullptr;
+    QVector<Obstacle*> freeList;
+    int maxFree = 256;
+    quint64 allocationCount = 0;
+};
+
+#endif // OBSTACLEPOOL_H
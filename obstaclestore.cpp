@@ -0,0 +1,241 @@
+#include "obstaclestore.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <algorithm>
+#include <cmath>
+
+void ObstacleStore::reserve(int capacity)
+{
+    xs.reserve(capacity);
+    ys.reserve(capacity);
+    prevYs.reserve(capacity);
+    y0s.reserve(capacity);
+    t0s.reserve(capacity);
+    speeds.reserve(capacity);
+    types.reserve(capacity);
+    alive.reserve(capacity);
+    generations.reserve(capacity);
+    freeSlots.reserve(capacity);
+    exitHeap.reserve(capacity);
+}
+
+void ObstacleStore::clear()
+{
+    // resize(0) сохраняет выделенную память в отличие от clear() в Qt 5
+    xs.resize(0);
+    ys.resize(0);
+    prevYs.resize(0);
+    y0s.resize(0);
+    t0s.resize(0);
+    speeds.resize(0);
+    types.resize(0);
+    alive.resize(0);
+    generations.resize(0);
+    freeSlots.resize(0);
+    exitHeap.resize(0);
+    speedBound = 0.0f;
+    liveCount = 0;
+}
+
+int ObstacleStore::spawn(int type, float x, float y, float speed, double now)
+{
+    int slot;
+    if (!freeSlots.isEmpty()) {
+        slot = freeSlots.takeLast();
+        xs[slot] = x;
+        ys[slot] = y;
+        prevYs[slot] = y;
+        y0s[slot] = y;
+        t0s[slot] = now;
+        speeds[slot] = speed;
+        types[slot] = static_cast<quint8>(type);
+        alive[slot] = 1;
+        ++generations[slot];
+    } else {
+        slot = xs.size();
+        xs.append(x);
+        ys.append(y);
+        prevYs.append(y);
+        y0s.append(y);
+        t0s.append(now);
+        speeds.append(speed);
+        types.append(static_cast<quint8>(type));
+        alive.append(1);
+        generations.append(0);
+    }
+    ++liveCount;
+    speedBound = std::max(speedBound, speed);
+    pushExit(slot);
+    return slot;
+}
+
+void ObstacleStore::remove(int slot)
+{
+    if (slot < 0 || slot >= xs.size() || !alive[slot]) return;
+
+    alive[slot] = 0;
+    // Запись в куче становится устаревшей и будет пропущена при извлечении
+    ++generations[slot];
+    freeSlots.append(slot);
+    --liveCount;
+}
+
+void ObstacleStore::pushExit(int slot)
+{
+    ExitEntry entry;
+    entry.time = exitTimeOf(slot);
+    entry.slot = slot;
+    entry.generation = generations[slot];
+    exitHeap.append(entry);
+    std::push_heap(exitHeap.begin(), exitHeap.end(), laterExit);
+}
+
+void ObstacleStore::advance(double now)
+{
+    // Позиция вычисляется из траектории, а не накапливается сложением,
+    // поэтому не зависит от числа и длины шагов
+    const int count = xs.size();
+    float *y = ys.data();
+    float *prev = prevYs.data();
+    const float *origin = y0s.constData();
+    const double *start = t0s.constData();
+    const float *v = speeds.constData();
+    for (int i = 0; i < count; ++i) {
+        prev[i] = y[i];
+        y[i] = origin[i] + v[i] * static_cast<float>(now - start[i]);
+    }
+}
+
+void ObstacleStore::collectExpired(double now, QVector<int> &slots)
+{
+    while (!exitHeap.isEmpty() && exitHeap.constFirst().time < now) {
+        std::pop_heap(exitHeap.begin(), exitHeap.end(), laterExit);
+        const ExitEntry entry = exitHeap.takeLast();
+        if (alive[entry.slot] && generations[entry.slot] == entry.generation) {
+            slots.append(entry.slot);
+        }
+    }
+}
+
+void ObstacleStore::scaleSpeeds(double factor, double now)
+{
+    if (factor <= 0.0) return;
+
+    const int count = xs.size();
+    float *origin = y0s.data();
+    double *start = t0s.data();
+    float *v = speeds.data();
+    const quint8 *a = alive.constData();
+    speedBound = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        if (a[i]) {
+            origin[i] = origin[i] + v[i] * static_cast<float>(now - start[i]);
+            start[i] = now;
+            v[i] = static_cast<float>(std::max(1.0, std::round(v[i] * factor)));
+            speedBound = std::max(speedBound, v[i]);
+        }
+    }
+
+    // Все моменты вылета изменились: перестроение кучи дешевле
+    // поштучного обновления записей
+    rebuildExits();
+}
+
+void ObstacleStore::rebuildExits()
+{
+    exitHeap.resize(0);
+    const int count = xs.size();
+    for (int i = 0; i < count; ++i) {
+        if (!alive[i]) continue;
+        ExitEntry entry;
+        entry.time = exitTimeOf(i);
+        entry.slot = i;
+        entry.generation = generations[i];
+        exitHeap.append(entry);
+    }
+    std::make_heap(exitHeap.begin(), exitHeap.end(), laterExit);
+}
+
+void ObstacleStore::save(QDataStream &out) const
+{
+    const int count = xs.size();
+    out << exitY << speedBound << qint32(count);
+    for (int i = 0; i < count; ++i) {
+        out << alive[i];
+        if (!alive[i]) continue;
+        out << types[i] << xs[i] << ys[i] << prevYs[i] << y0s[i] << t0s[i] << speeds[i];
+    }
+    out << qint32(freeSlots.size());
+    for (int slot : freeSlots) {
+        out << qint32(slot);
+    }
+}
+
+bool ObstacleStore::load(QDataStream &in, int typeCount)
+{
+    float limitY = 0.0f;
+    float bound = 0.0f;
+    qint32 count = 0;
+    in >> limitY >> bound >> count;
+    // Каждый слот занимает в потоке хотя бы байт флага: число слотов не
+    // может превышать остаток данных, иначе снимок испорчен
+    if (in.status() != QDataStream::Ok || count < 0 || !std::isfinite(limitY) || !std::isfinite(bound)
+        || (in.device() && count > in.device()->bytesAvailable())) {
+        return false;
+    }
+
+    // Разбор идёт в отдельное хранилище; текущее заменяется только
+    // после проверки всего снимка
+    ObstacleStore loaded;
+    loaded.reserve(count);
+    loaded.exitY = limitY;
+    // Оценка скорости — максимум с последнего scaleSpeeds(), а не по живым
+    // препятствиям: от неё зависит зона широкой фазы и счётчики кандидатов
+    loaded.speedBound = bound;
+    for (int i = 0; i < count; ++i) {
+        quint8 isAlive = 0;
+        quint8 type = 0;
+        float x = 0.0f, y = 0.0f, prevY = 0.0f, y0 = 0.0f, speed = 0.0f;
+        double t0 = 0.0;
+        in >> isAlive;
+        if (isAlive) {
+            in >> type >> x >> y >> prevY >> y0 >> t0 >> speed;
+            if (in.status() != QDataStream::Ok) return false;
+            // Тип индексирует маски, а скорость — делитель времени вылета
+            if (type >= typeCount || !(speed > 0.0f) || !std::isfinite(speed) || !std::isfinite(x)
+                || !std::isfinite(y) || !std::isfinite(prevY) || !std::isfinite(y0) || !std::isfinite(t0)) {
+                return false;
+            }
+            ++loaded.liveCount;
+        }
+        loaded.xs.append(x);
+        loaded.ys.append(y);
+        loaded.prevYs.append(prevY);
+        loaded.y0s.append(y0);
+        loaded.t0s.append(t0);
+        loaded.speeds.append(speed);
+        loaded.types.append(type);
+        loaded.alive.append(isAlive ? 1 : 0);
+        loaded.generations.append(0);
+    }
+
+    // Свободные слоты — ровно мёртвые, каждый по одному разу
+    qint32 freeCount = 0;
+    in >> freeCount;
+    if (in.status() != QDataStream::Ok || freeCount != count - loaded.liveCount) return false;
+    QVector<quint8> listed(count, 0);
+    loaded.freeSlots.reserve(freeCount);
+    for (int i = 0; i < freeCount; ++i) {
+        qint32 slot = 0;
+        in >> slot;
+        if (in.status() != QDataStream::Ok || slot < 0 || slot >= count || loaded.alive[slot] || listed[slot]) {
+            return false;
+        }
+        listed[slot] = 1;
+        loaded.freeSlots.append(slot);
+    }
+
+    loaded.rebuildExits();
+    std::swap(*this, loaded);
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef OBSTACLESTORE_H
+#define OBSTACLESTORE_H
+
+#include <QVector>
+
+class QDataStream;
+
+// Хранилище состояния препятствий в виде структуры массивов.
+// Каждое препятствие занимает слот; индексы слотов стабильны, пока
+// препятствие живо, освобождённые слоты переиспользуются.
+// Между изменениями сложности препятствие падает равномерно, поэтому
+// хранится траектория y(t) = y0 + v * (t - t0), а момент вылета за
+// нижнюю границу известен заранее: он лежит в min-куче, и за шаг
+// извлекаются только действительно вылетевшие препятствия.
+// Время измеряется в базовых тактах симуляции.
+class ObstacleStore
+{
+public:
+    void reserve(int capacity);
+    void clear();
+
+    // Граница, пересечение которой считается вылетом
+    void setExitY(float limitY) { exitY = limitY; }
+
+    // Возвращает номер слота нового препятствия, появившегося в момент now
+    int spawn(int type, float x, float y, float speed, double now = 0.0);
+    void remove(int slot);
+
+    int slotCount() const { return xs.size(); }
+    int aliveCount() const { return liveCount; }
+
+    bool isAlive(int slot) const { return alive[slot] != 0; }
+    int type(int slot) const { return types[slot]; }
+    float x(int slot) const { return xs[slot]; }
+    float y(int slot) const { return ys[slot]; }
+    float previousY(int slot) const { return prevYs[slot]; }
+    float speed(int slot) const { return speeds[slot]; }
+    // Верхняя оценка скорости живых препятствий (широкая фаза
+    // непрерывных столкновений); сбрасывается в clear()
+    float maxSpeed() const { return speedBound; }
+
+    // Позиции всех препятствий в момент now по их траекториям;
+    // прежние позиции сохраняются для интерполяции
+    void advance(double now);
+
+    // Извлекает из кучи препятствия, вылетевшие к моменту now
+    // (y(now) > exitY), и добавляет их в slots в порядке вылета.
+    // Сами препятствия не удаляются — это делает вызывающий через remove()
+    void collectExpired(double now, QVector<int> &slots);
+
+    // Умножает скорости с округлением до целого (не меньше 1).
+    // Траектории переносятся в момент now одним проходом, куча
+    // перестраивается целиком за O(n)
+    void scaleSpeeds(double factor, double now);
+
+    // Двоичное состояние для снимков GameSimulation: живые слоты и порядок
+    // свободных (он определяет номера будущих слотов). Куча вылетов
+    // не сохраняется, а перестраивается по слотам. load() проверяет снимок
+    // целиком (типы меньше typeCount, положительные скорости, список
+    // свободных слотов) и при ошибке оставляет хранилище как было
+    void save(QDataStream &out) const;
+    bool load(QDataStream &in, int typeCount);
+
+private:
+    // Запись кучи; generation отсекает записи удалённых и
+    // переиспользованных слотов без поиска по куче
+    struct ExitEntry {
+        double time;
+        int slot;
+        quint32 generation;
+    };
+    // Упорядочивание для min-кучи; при равном времени — по слоту,
+    // чтобы порядок вылета не зависел от истории кучи
+    static bool laterExit(const ExitEntry &a, const ExitEntry &b)
+    {
+        return a.time > b.time || (a.time == b.time && a.slot > b.slot);
+    }
+
+    double exitTimeOf(int slot) const { return t0s[slot] + (exitY - y0s[slot]) / speeds[slot]; }
+    void pushExit(int slot);
+    void rebuildExits();
+
+    QVector<float> xs;
+    QVector<float> ys;
+    QVector<float> prevYs;
+    QVector<float> y0s;
+    QVector<double> t0s;
+    QVector<float> speeds;
+    QVector<quint8> types;
+    QVector<quint8> alive;
+    QVector<quint32> generations;
+    QVector<int> freeSlots;
+    QVector<ExitEntry> exitHeap;
+    float exitY = 600.0f;
+    float speedBound = 0.0f;
+    int liveCount = 0;
+};
+
+#endif // OBSTACLESTORE_H
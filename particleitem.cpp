@@ -0,0 +1,103 @@
+#include "particleitem.h"
+#include "particlesystem.h"
+#include "gamesimulation.h"
+#include <QRadialGradient>
+#include <QStyleOptionGraphicsItem>
+
+ParticleItem::ParticleItem(const ParticleSystem *system, QGraphicsItem *parent)
+    : QGraphicsItem(parent), particles(system),
+      bounds(0, 0, GameSimulation::FieldWidth, GameSimulation::FieldHeight)
+{
+    // Атлас: по мягкой точке на вид частиц, в ряд
+    const QColor colors[ParticleSystem::KindCount] = {
+        QColor(255, 170, 40),   // Spark
+        QColor(110, 110, 110),  // Smoke
+        QColor(255, 80, 120),   // HeartGlow
+        QColor(255, 225, 60),   // StarGlow
+    };
+    atlas = QPixmap(DotSize * ParticleSystem::KindCount, DotSize);
+    atlas.fill(Qt::transparent);
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    for (int kind = 0; kind < ParticleSystem::KindCount; ++kind) {
+        const QPointF center(kind * DotSize + DotSize / 2.0, DotSize / 2.0);
+        QRadialGradient gradient(center, DotSize / 2.0);
+        gradient.setColorAt(0, colors[kind]);
+        gradient.setColorAt(1, QColor(colors[kind].red(), colors[kind].green(), colors[kind].blue(), 0));
+        painter.setBrush(gradient);
+        painter.drawEllipse(center, DotSize / 2.0, DotSize / 2.0);
+    }
+    painter.end();
+
+    fragments.reserve(particles->capacity());
+    // Над спрайтами, под HUD и надписями
+    setZValue(80);
+    // exposedRect в paint(): частицы вне видимой области не выводятся
+    setFlag(ItemUsesExtendedStyleOption);
+}
+
+void ParticleItem::sync()
+{
+    const bool hasParticles = particles->size() > 0;
+    if (hasParticles || hadParticles) {
+        update();
+    }
+    hadParticles = hasParticles;
+}
+
+void ParticleItem::setBounds(const QRectF &rect)
+{
+    prepareGeometryChange();
+    bounds = rect;
+}
+
+QRectF ParticleItem::boundingRect() const
+{
+    return bounds;
+}
+
+void ParticleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    const int count = particles->size();
+    if (count == 0) return;
+
+    const float *xs = particles->xData();
+    const float *ys = particles->yData();
+    const float *alphas = particles->alphaData();
+    const quint8 *kinds = particles->kindData();
+
+    // В большом мире видна лишь часть элемента: точки вне открытой
+    // области (с запасом на размер точки) отбрасываются
+    const QRectF &exposed = option->exposedRect;
+    const float left = static_cast<float>(exposed.left()) - DotSize;
+    const float right = static_cast<float>(exposed.right()) + DotSize;
+    const float top = static_cast<float>(exposed.top()) - DotSize;
+    const float bottom = static_cast<float>(exposed.bottom()) + DotSize;
+
+    // Поля фрагмента заполняются напрямую: create() на десятки тысяч
+    // частиц заметно дороже
+    fragments.resize(count);
+    QPainter::PixmapFragment *out = fragments.data();
+    int visible = 0;
+    for (int i = 0; i < count; ++i) {
+        if (xs[i] < left || xs[i] > right || ys[i] < top || ys[i] > bottom) continue;
+        QPainter::PixmapFragment &fragment = out[visible++];
+        const qreal scale = 0.5 + 0.5 * alphas[i];
+        fragment.x = xs[i];
+        fragment.y = ys[i];
+        fragment.sourceLeft = kinds[i] * DotSize;
+        fragment.sourceTop = 0;
+        fragment.width = DotSize;
+        fragment.height = DotSize;
+        fragment.scaleX = scale;
+        fragment.scaleY = scale;
+        fragment.rotation = 0;
+        fragment.opacity = alphas[i];
+    }
+    if (visible > 0) {
+        painter->drawPixmapFragments(fragments.constData(), visible, atlas);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef PARTICLEITEM_H
+#define PARTICLEITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPixmap>
+#include <QVector>
+
+class ParticleSystem;
+
+// Все частицы ParticleSystem одним элементом сцены: в paint() из буфера
+// частиц собираются фрагменты маленького атласа точек и выводятся одним
+// вызовом drawPixmapFragments(). Отдельных QGraphicsItem на частицу нет.
+class ParticleItem : public QGraphicsItem
+{
+public:
+    explicit ParticleItem(const ParticleSystem *system, QGraphicsItem *parent = nullptr);
+
+    // Вызывается после ParticleSystem::update(); перерисовка только
+    // пока есть частицы и один раз после исчезновения последней
+    void sync();
+
+    // Область, в которой могут быть частицы (обычно весь мир)
+    void setBounds(const QRectF &rect);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    static constexpr int DotSize = 8;
+
+    const ParticleSystem *particles;
+    QRectF bounds;
+    QPixmap atlas;
+    QVector<QPainter::PixmapFragment> fragments;
+    bool hadParticles = false;
+};
+
+#endif // PARTICLEITEM_H
@@ -0,0 +1,142 @@
+#include "particlesystem.h"
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Параметры вспышки по виду частиц; скорости в пикселях за миллисекунду
+struct KindParams {
+    float minSpeed;
+    float maxSpeed;
+    float gravity;      // пикселей/мс², отрицательная — всплывает
+    float minLifetime;  // мс
+    float maxLifetime;
+};
+
+const KindParams Params[ParticleSystem::KindCount] = {
+    { 0.15f, 0.60f,  0.0008f, 250.0f,  600.0f }, // Spark
+    { 0.02f, 0.12f, -0.0001f, 500.0f, 1000.0f }, // Smoke
+    { 0.05f, 0.25f, -0.0002f, 400.0f,  800.0f }, // HeartGlow
+    { 0.10f, 0.40f,  0.0001f, 350.0f,  750.0f }, // StarGlow
+};
+
+// Скорость теряет половину за DragHalfLifeMs
+const double DragHalfLifeMs = 300.0;
+}
+
+ParticleSystem::ParticleSystem(int capacity)
+{
+    maxCount = qMax(0, capacity);
+    const int padded = (maxCount + 3) & ~3;
+    for (QVector<float> *array : { &xs, &ys, &vxs, &vys, &gravities, &lifes, &invLifetimes, &alphas }) {
+        array->fill(0.0f, padded);
+    }
+    kinds.fill(0, padded);
+}
+
+float ParticleSystem::random(float lowest, float highest)
+{
+    return lowest + (highest - lowest) * (rng.generate() * (1.0f / 4294967296.0f));
+}
+
+void ParticleSystem::burst(Kind kind, float x, float y, int amount)
+{
+    const KindParams &params = Params[kind];
+    const int end = qMin(maxCount, count + qMax(0, amount));
+    for (int i = count; i < end; ++i) {
+        const float angle = random(0.0f, 6.2831853f);
+        const float speed = random(params.minSpeed, params.maxSpeed);
+        const float lifetime = random(params.minLifetime, params.maxLifetime);
+        xs[i] = x;
+        ys[i] = y;
+        vxs[i] = std::cos(angle) * speed;
+        vys[i] = std::sin(angle) * speed;
+        gravities[i] = params.gravity;
+        lifes[i] = lifetime;
+        invLifetimes[i] = 1.0f / lifetime;
+        alphas[i] = 1.0f;
+        kinds[i] = kind;
+    }
+    count = end;
+}
+
+void ParticleSystem::update(double dtMs)
+{
+    if (count == 0 || dtMs <= 0.0) return;
+    const float drag = static_cast<float>(std::pow(0.5, dtMs / DragHalfLifeMs));
+    integrate(static_cast<float>(dtMs), drag);
+    compact();
+}
+
+void ParticleSystem::integrate(float dt, float drag)
+{
+    float *x = xs.data();
+    float *y = ys.data();
+    float *vx = vxs.data();
+    float *vy = vys.data();
+    const float *g = gravities.constData();
+    float *life = lifes.data();
+    const float *invLifetime = invLifetimes.constData();
+    float *alpha = alphas.data();
+
+    int i = 0;
+#if defined(__SSE2__)
+    const int padded = (count + 3) & ~3;
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vdrag = _mm_set1_ps(drag);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i < padded; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pvx = _mm_loadu_ps(vx + i);
+        __m128 pvy = _mm_loadu_ps(vy + i);
+        __m128 plife = _mm_loadu_ps(life + i);
+
+        pvx = _mm_mul_ps(pvx, vdrag);
+        pvy = _mm_add_ps(_mm_mul_ps(pvy, vdrag), _mm_mul_ps(_mm_loadu_ps(g + i), vdt));
+        px = _mm_add_ps(px, _mm_mul_ps(pvx, vdt));
+        py = _mm_add_ps(py, _mm_mul_ps(pvy, vdt));
+        plife = _mm_sub_ps(plife, vdt);
+        const __m128 palpha = _mm_max_ps(_mm_mul_ps(plife, _mm_loadu_ps(invLifetime + i)), zero);
+
+        _mm_storeu_ps(x + i, px);
+        _mm_storeu_ps(y + i, py);
+        _mm_storeu_ps(vx + i, pvx);
+        _mm_storeu_ps(vy + i, pvy);
+        _mm_storeu_ps(life + i, plife);
+        _mm_storeu_ps(alpha + i, palpha);
+    }
+#endif
+    for (; i < count; ++i) {
+        vx[i] *= drag;
+        vy[i] = vy[i] * drag + g[i] * dt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        life[i] -= dt;
+        alpha[i] = qMax(life[i] * invLifetime[i], 0.0f);
+    }
+}
+
+void ParticleSystem::compact()
+{
+    // Умершая частица замещается последней живой; порядок отрисовки не важен
+    int i = 0;
+    while (i < count) {
+        if (lifes[i] > 0.0f) {
+            ++i;
+            continue;
+        }
+        const int last = --count;
+        xs[i] = xs[last];
+        ys[i] = ys[last];
+        vxs[i] = vxs[last];
+        vys[i] = vys[last];
+        gravities[i] = gravities[last];
+        lifes[i] = lifes[last];
+        invLifetimes[i] = invLifetimes[last];
+        alphas[i] = alphas[last];
+        kinds[i] = kinds[last];
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include <QVector>
+#include "gamerng.h"
+
+// Частицы эффектов: искры и дым при попаданиях, вспышки при подборе
+// сердец и звёзд. Буфер фиксированной ёмкости в виде структуры массивов:
+// живые частицы занимают индексы [0, size()), умершие замещаются последними.
+// Обновление — векторное ядро (SSE2, по 4 частицы) и отдельный скалярный
+// проход уплотнения. Сцены не касается: рисует ParticleItem одним вызовом.
+class ParticleSystem
+{
+public:
+    enum Kind : quint8 { Spark, Smoke, HeartGlow, StarGlow, KindCount };
+
+    explicit ParticleSystem(int capacity = 32768);
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+    int capacity() const { return maxCount; }
+
+    // Вспышка из amount частиц вокруг (x, y); сверх ёмкости частицы не создаются
+    void burst(Kind kind, float x, float y, int amount);
+
+    // Движение, сопротивление, гравитация и угасание за dtMs миллисекунд
+    void update(double dtMs);
+
+    // Данные для отрисовки, индексы [0, size())
+    const float *xData() const { return xs.constData(); }
+    const float *yData() const { return ys.constData(); }
+    const float *alphaData() const { return alphas.constData(); }
+    const quint8 *kindData() const { return kinds.constData(); }
+
+private:
+    void integrate(float dt, float drag);
+    void compact();
+    float random(float lowest, float highest);
+
+    // Массивы дополнены до кратного 4, поэтому ядро обрабатывает
+    // последнюю неполную четвёрку без скалярного хвоста
+    QVector<float> xs;
+    QVector<float> ys;
+    QVector<float> vxs;
+    QVector<float> vys;
+    QVector<float> gravities;
+    QVector<float> lifes;        // оставшееся время жизни, мс
+    QVector<float> invLifetimes; // 1 / полное время жизни
+    QVector<float> alphas;
+    QVector<quint8> kinds;
+    int maxCount = 0;
+    int count = 0;
+    GameRng rng{0x9e3779b97f4a7c15ULL};
+};
+
+#endif // PARTICLESYSTEM_H
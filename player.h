@@ -2,7 +2,6 @@
 #define PLAYER_H
 
 #include "gameobject.h"
-#include <QKeyEvent>
 #include <QPainter>
 #include <QTimer>
 
@@ -11,28 +10,27 @@ class Player : public GameObject
     Q_OBJECT
 
 public:
+    static constexpr int SpriteSize = 60;
+
     explicit Player(QGraphicsItem *parent = nullptr);
 
+    // Рисует лицо в квадрат SpriteSize x SpriteSize; используется SpriteCache
+    static void paintFace(QPainter *painter);
+
     // Реализация чисто виртуальных методов из GameObject
     void update() override {}
     void reset() override;
     int getType() const override { return 0; } // 0 = игрок
 
-    // Специфичные для Player методы
-    void keyPressEvent(QKeyEvent *event) override;
-    int getLives() const;
-    void decreaseLife();
-    void increaseLife();
+    // Мигание при получении урона; жизни хранит GameSimulation.
+    // Позицию задаёт Game по снимку симуляции, клавиши сюда не приходят
+    void showDamage();
 
 signals:
     void lifeLost();
 
 private:
     void handleCollision() override {}
-    QPixmap createFacePixmap();
-
-    int lives;
-    int speed;
 };
 
 #endif // PLAYER_H
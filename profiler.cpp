@@ -0,0 +1,126 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+
+RollingHistogram::RollingHistogram(int capacity)
+{
+    samples.resize(qMax(1, capacity));
+}
+
+void RollingHistogram::add(double value)
+{
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+    filled = qMin(filled + 1, samples.size());
+    lastValue = value;
+}
+
+void RollingHistogram::clear()
+{
+    next = 0;
+    filled = 0;
+    lastValue = 0.0;
+}
+
+double RollingHistogram::percentile(double p) const
+{
+    if (filled == 0) return 0.0;
+
+    // Перцентили нужны редко (оверлей, отчёты), поэтому считаются по копии окна
+    QVector<double> sorted(samples.constBegin(), samples.constBegin() + filled);
+    const int rank = qBound(0, static_cast<int>(std::ceil(p / 100.0 * filled)) - 1, filled - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+Profiler::Profiler(int windowSize)
+{
+    histograms.fill(RollingHistogram(windowSize), SectionCount);
+    counters.fill(0, CounterCount);
+}
+
+void Profiler::addSample(Section section, qint64 nsecs)
+{
+    histograms[section].add(nsecs / 1e6);
+}
+
+SectionStats Profiler::stats(Section section) const
+{
+    const RollingHistogram &histogram = histograms[section];
+    SectionStats result;
+    result.last = histogram.last();
+    result.p50 = histogram.percentile(50);
+    result.p95 = histogram.percentile(95);
+    result.p99 = histogram.percentile(99);
+    result.samples = histogram.count();
+    return result;
+}
+
+void Profiler::reset()
+{
+    for (RollingHistogram &histogram : histograms) {
+        histogram.clear();
+    }
+    counters.fill(0);
+}
+
+const char *Profiler::sectionName(Section section)
+{
+    switch (section) {
+    case Tick: return "tick";
+    case Spawn: return "spawn";
+    case Movement: return "movement";
+    case Collision: return "collision";
+    case Hud: return "hud";
+    case Sync: return "sync";
+    case Render: return "render";
+    case Autopilot: return "autopilot";
+    case Snapshot: return "snapshot";
+    case Particles: return "particles";
+    case InputLatency: return "input latency";
+    case SectionCount: break;
+    }
+    return "";
+}
+
+const char *Profiler::counterName(Counter counter)
+{
+    switch (counter) {
+    case LiveObstacles: return "obstacles";
+    case PoolFree: return "pool free";
+    case PoolAllocations: return "pool allocs";
+    case SpriteRasterizations: return "rasterized";
+    case CandidatePairs: return "candidates";
+    case NarrowTests: return "narrow";
+    case HudRelayouts: return "hud layouts";
+    case LiveParticles: return "particles";
+    case AutopilotRollouts: return "ap rollouts";
+    case AutopilotSteps: return "ap steps";
+    case CounterCount: break;
+    }
+    return "";
+}
+
+QString Profiler::summary() const
+{
+    QString text = QStringLiteral("%1 %2 %3 %4\n")
+                       .arg(QStringLiteral("ms"), -10)
+                       .arg(QStringLiteral("p50"), 6)
+                       .arg(QStringLiteral("p95"), 6)
+                       .arg(QStringLiteral("p99"), 6);
+    for (int i = 0; i < SectionCount; ++i) {
+        const SectionStats s = stats(static_cast<Section>(i));
+        text += QStringLiteral("%1 %2 %3 %4\n")
+                    .arg(QString::fromLatin1(sectionName(static_cast<Section>(i))), -10)
+                    .arg(s.p50, 6, 'f', 3)
+                    .arg(s.p95, 6, 'f', 3)
+                    .arg(s.p99, 6, 'f', 3);
+    }
+    for (int i = 0; i < CounterCount; ++i) {
+        text += QStringLiteral("%1 %2\n")
+                    .arg(QString::fromLatin1(counterName(static_cast<Counter>(i))), -10)
+                    .arg(counters[i]);
+    }
+    text.chop(1);
+    return text;
+}
@@ -0,0 +1,118 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// Скользящее окно последних измерений для перцентилей
+class RollingHistogram
+{
+public:
+    explicit RollingHistogram(int capacity = 512);
+
+    void add(double value);
+    void clear();
+
+    int count() const { return filled; }
+    double last() const { return lastValue; }
+    // p в диапазоне [0, 100]
+    double percentile(double p) const;
+
+private:
+    QVector<double> samples;
+    int next = 0;
+    int filled = 0;
+    double lastValue = 0.0;
+};
+
+// Сводка по одному участку кадра, миллисекунды
+struct SectionStats {
+    double last = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    int samples = 0;
+};
+
+// Профилировщик горячего пути: время участков кадра и счётчики объектов.
+// Данные доступны оверлею Game и программно (тесты, бенчмарки).
+class Profiler
+{
+public:
+    enum Section {
+        Tick,       // весь такт
+        Spawn,      // спавн волн
+        Movement,   // движение игрока и препятствий, поиск вылетевших
+        Collision,  // широкая и узкая фазы
+        Hud,        // обработка событий шага: спрайты и отметки HUD
+        Sync,       // перенос позиций и HUD в элементы сцены
+        Render,     // отрисовка сцены
+        Autopilot,  // поиск хода ботом
+        Snapshot,   // снимок состояния в кольцо перемотки
+        Particles,  // движение и угасание частиц эффектов
+        InputLatency, // от нажатия клавиши до показанного кадра с её результатом
+        SectionCount
+    };
+
+    enum Counter {
+        LiveObstacles,
+        PoolFree,
+        PoolAllocations,
+        SpriteRasterizations,
+        CandidatePairs,
+        NarrowTests,
+        HudRelayouts,
+        LiveParticles,
+        AutopilotRollouts, // прогоны и шаги симуляции последнего решения бота
+        AutopilotSteps,
+        CounterCount
+    };
+
+    // windowSize — число последних измерений, по которым считаются перцентили
+    explicit Profiler(int windowSize = 512);
+
+    void addSample(Section section, qint64 nsecs);
+    SectionStats stats(Section section) const;
+
+    void setCounter(Counter counter, qint64 value) { counters[counter] = value; }
+    qint64 counter(Counter counter) const { return counters[counter]; }
+
+    void reset();
+
+    static const char *sectionName(Section section);
+    static const char *counterName(Counter counter);
+
+    // Многострочный текст для оверлея
+    QString summary() const;
+
+private:
+    QVector<RollingHistogram> histograms;
+    QVector<qint64> counters;
+};
+
+// Замер участка до конца области видимости; при profiler == nullptr ничего не делает
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler *profiler, Profiler::Section section)
+        : profiler(profiler), section(section)
+    {
+        if (profiler) timer.start();
+    }
+
+    ~ProfileScope()
+    {
+        if (profiler) profiler->addSample(section, timer.nsecsElapsed());
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    Profiler *profiler;
+    Profiler::Section section;
+    QElapsedTimer timer;
+};
+
+#endif // PROFILER_H
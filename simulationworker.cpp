@@ -0,0 +1,217 @@
+#include "simulationworker.h"
+#include "trace.h"
+#include <cmath>
+
+SimulationWorker::SimulationWorker(const GameSimulation &prototype, QObject *parent)
+    : QThread(parent), simulation(prototype)
+{
+    // Профилировщик принадлежит потоку GUI
+    simulation.setProfiler(nullptr);
+    clock.start();
+}
+
+SimulationWorker::~SimulationWorker()
+{
+    shutdown();
+}
+
+void SimulationWorker::post(const WorkerCommand &command)
+{
+    // Очередь большая, переполнение возможно лишь если поток завис;
+    // команду терять нельзя, поэтому ждём
+    while (!commands.push(command)) {
+        wakeups.release();
+        QThread::yieldCurrentThread();
+    }
+    wakeups.release();
+}
+
+void SimulationWorker::shutdown()
+{
+    if (!isRunning()) return;
+    WorkerCommand command;
+    command.type = WorkerCommand::Quit;
+    post(command);
+    wait();
+}
+
+void SimulationWorker::run()
+{
+    Trace::setThreadName("simulation");
+    lastNs = nowNs();
+    for (;;) {
+        if (!drainCommands()) return;
+
+        if (!running || simulation.isGameOver()) {
+            // Спим до следующей команды, без периодических пробуждений
+            wakeups.acquire();
+            lastNs = nowNs();
+            accumulatorMs = 0.0;
+            continue;
+        }
+
+        const qint64 now = nowNs();
+        // Как и в Game::advanceFrame(): после долгой задержки не догоняем время
+        accumulatorMs += qBound(0.0, (now - lastNs) / 1e6, 250.0);
+        lastNs = now;
+
+        bool stepped = false;
+        while (accumulatorMs >= GameSimulation::TickMs && !simulation.isGameOver()) {
+            accumulatorMs -= GameSimulation::TickMs;
+            stepOnce();
+            stepped = true;
+        }
+        if (stepped) {
+            publish();
+        }
+
+        // Ожидание до следующего шага; ввод будит поток раньше
+        const int waitMs = qMax(0, static_cast<int>(std::ceil(GameSimulation::TickMs - accumulatorMs)));
+        wakeups.tryAcquire(1, waitMs);
+    }
+}
+
+bool SimulationWorker::drainCommands()
+{
+    WorkerCommand command;
+    bool changed = false;
+    while (commands.pop(command)) {
+        switch (command.type) {
+        case WorkerCommand::Start:
+            if (!running) {
+                running = true;
+                accumulatorMs = 0.0;
+                lastNs = nowNs();
+            }
+            break;
+        case WorkerCommand::Stop:
+            running = false;
+            break;
+        case WorkerCommand::Reset:
+            session = command.session;
+            simulation.reset(command.value);
+            keys = KeyDirection();
+            history.clear();
+            quickSave.clear();
+            tick = 0;
+            lastStepCostNs = 0;
+            lastStepNs = nowNs();
+            changed = true;
+            break;
+        case WorkerCommand::KeyPress:
+            keys.press(static_cast<int>(command.value));
+            receivedInputSequence = command.sequence;
+            break;
+        case WorkerCommand::KeyRelease:
+            keys.release(static_cast<int>(command.value));
+            receivedInputSequence = command.sequence;
+            break;
+        case WorkerCommand::Spawn:
+            simulation.clearEvents();
+            simulation.spawnObject(static_cast<int>(command.value));
+            changed = true;
+            break;
+        case WorkerCommand::RemoveAll:
+            simulation.removeAllObjects();
+            changed = true;
+            break;
+        case WorkerCommand::SetAutopilot:
+            autopilotEnabled = command.value != 0;
+            if (autopilotEnabled && !autopilot) {
+                autopilot.reset(new Autopilot());
+            }
+            break;
+        case WorkerCommand::Rewind: {
+            quint32 restoredTick = 0;
+            if (history.rewind(static_cast<quint32>(command.value), tick, simulation, restoredTick)) {
+                Trace::instant(Trace::Rewind, static_cast<qint32>(command.value));
+                restored(restoredTick);
+            }
+            // Снимок публикуется и при неудаче: по restoreSequence GUI
+            // узнаёт, что ответ на запрос уже есть
+            restoreSequence = command.sequence;
+            changed = true;
+            break;
+        }
+        case WorkerCommand::SaveState:
+            simulation.saveState(quickSave);
+            quickSaveTick = tick;
+            break;
+        case WorkerCommand::LoadState:
+            if (!quickSave.isEmpty() && simulation.restoreState(quickSave)) {
+                // Снимки кольца относятся к другой ветке событий
+                history.clear();
+                restored(quickSaveTick);
+            }
+            restoreSequence = command.sequence;
+            changed = true;
+            break;
+        case WorkerCommand::Quit:
+            return false;
+        }
+    }
+
+    // Сброс и ручной спавн видны сразу, не дожидаясь следующего шага
+    if (changed) {
+        publish();
+    }
+    return true;
+}
+
+void SimulationWorker::restored(quint32 restoredTick)
+{
+    tick = restoredTick;
+    lastStepCostNs = 0;
+    lastStepNs = nowNs();
+    accumulatorMs = 0.0;
+    lastNs = nowNs();
+}
+
+void SimulationWorker::stepOnce()
+{
+    QElapsedTimer cost;
+    cost.start();
+    TraceScope traceScope(Trace::Tick);
+
+    // Команды ввода применены в drainCommands() перед этим шагом
+    steppedInputSequence = receivedInputSequence;
+    SimInput input;
+    if (autopilotEnabled) {
+        TraceScope autopilotScope(Trace::Autopilot);
+        input.direction = autopilot->decide(simulation);
+    } else {
+        input.direction = keys.direction();
+    }
+    simulation.step(GameSimulation::TickMs, input);
+    simulation.traceEvents();
+    ++tick;
+    if (tick % SnapshotRing::Interval == 0) {
+        history.push(tick, simulation);
+    }
+
+    lastStepCostNs = cost.nsecsElapsed();
+    lastStepNs = nowNs();
+
+    WorkerEvent event;
+    event.session = session;
+    for (const SimEvent &simEvent : simulation.events()) {
+        event.event = simEvent;
+        // События нужны только для оформления (мигание, надписи);
+        // при переполнении лучше потерять их, чем задержать симуляцию
+        events.push(event);
+    }
+}
+
+void SimulationWorker::publish()
+{
+    FrameSnapshot &snapshot = frames.writeBuffer();
+    snapshot.capture(simulation);
+    snapshot.session = session;
+    snapshot.tick = tick;
+    snapshot.stepNs = lastStepNs;
+    snapshot.stepCostNs = lastStepCostNs;
+    snapshot.inputSequence = steppedInputSequence;
+    snapshot.restoreSequence = restoreSequence;
+    snapshot.autopilot = autopilotEnabled ? autopilot->getStats() : AutopilotStats();
+    frames.publish();
+}
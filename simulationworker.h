@@ -0,0 +1,106 @@
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
+#include <memory>
+#include "framesnapshot.h"
+#include "autopilot.h"
+#include "gamesimulation.h"
+#include "inputrecording.h"
+#include "snapshotring.h"
+#include "spscqueue.h"
+#include "triplebuffer.h"
+
+// Команда потоку симуляции
+struct WorkerCommand {
+    enum Type : quint8 {
+        Start,      // запустить шаги по часам
+        Stop,       // приостановить
+        Reset,      // новая сессия: value — seed, session — её номер
+        KeyPress,   // value — код клавиши
+        KeyRelease,
+        Spawn,      // value — тип препятствия
+        RemoveAll,
+        SetAutopilot, // value — 1 включить, 0 выключить
+        Rewind,     // value — на сколько шагов назад
+        SaveState,  // быстрое сохранение в память потока
+        LoadState,
+        Quit
+    };
+
+    Type type = Start;
+    quint32 session = 0;
+    quint32 sequence = 0;   // KeyPress/KeyRelease: номер команды InputQueue;
+                            // Rewind/LoadState: номер запроса восстановления
+    quint64 value = 0;
+};
+
+// Событие шага с номером сессии, в которой оно произошло
+struct WorkerEvent {
+    quint32 session = 0;
+    SimEvent event;
+};
+
+// Поток симуляции: фиксированные шаги GameSimulation по собственным
+// часам, независимо от отрисовки. Обмен с потоком GUI без блокировок:
+// команды и ввод — очередь SPSC, события шагов — обратная очередь SPSC,
+// состояние для отрисовки — тройной буфер снимков FrameSnapshot.
+// Семафор служит только для пробуждения спящего потока.
+class SimulationWorker : public QThread
+{
+public:
+    // Симуляция копируется вместе с настройками (маски, сложность)
+    explicit SimulationWorker(const GameSimulation &prototype, QObject *parent = nullptr);
+    ~SimulationWorker() override;
+
+    // Поток GUI
+    void post(const WorkerCommand &command);
+    bool popEvent(WorkerEvent &event) { return events.pop(event); }
+    // Забирает последний снимок; false — нового с прошлого вызова нет
+    bool updateFrame() { return frames.update(); }
+    const FrameSnapshot &frame() const { return frames.readBuffer(); }
+    // Завершает поток и дожидается его
+    void shutdown();
+
+    // Часы, по которым отмечены снимки (stepNs)
+    qint64 nowNs() const { return clock.nsecsElapsed(); }
+
+protected:
+    void run() override;
+
+private:
+    bool drainCommands();
+    void stepOnce();
+    void restored(quint32 restoredTick);
+    void publish();
+
+    // Только поток симуляции
+    GameSimulation simulation;
+    KeyDirection keys;
+    std::unique_ptr<Autopilot> autopilot;
+    bool autopilotEnabled = false;
+    quint32 session = 0;
+    quint32 tick = 0;
+    bool running = false;
+    quint32 receivedInputSequence = 0;
+    quint32 steppedInputSequence = 0;
+    quint32 restoreSequence = 0;
+    SnapshotRing history;
+    QByteArray quickSave;
+    quint32 quickSaveTick = 0;
+    double accumulatorMs = 0.0;
+    qint64 lastNs = 0;
+    qint64 lastStepNs = 0;
+    qint64 lastStepCostNs = 0;
+
+    // Общие
+    QElapsedTimer clock;
+    QSemaphore wakeups;
+    SpscQueue<WorkerCommand, 256> commands;
+    SpscQueue<WorkerEvent, 1024> events;
+    TripleBuffer<FrameSnapshot> frames;
+};
+
+#endif // SIMULATIONWORKER_H
@@ -0,0 +1,51 @@
+#include "snapshotring.h"
+#include "gamesimulation.h"
+
+SnapshotRing::SnapshotRing(int capacity)
+{
+    entries.resize(qMax(1, capacity));
+}
+
+void SnapshotRing::clear()
+{
+    // Буферы остаются выделенными для следующей сессии
+    next = 0;
+    count = 0;
+}
+
+int SnapshotRing::indexFromNewest(int age) const
+{
+    const int size = entries.size();
+    return (next - 1 - age + size) % size;
+}
+
+void SnapshotRing::push(quint32 tick, const GameSimulation &simulation)
+{
+    Entry &entry = entries[next];
+    entry.tick = tick;
+    simulation.saveState(entry.state);
+    next = (next + 1) % entries.size();
+    count = qMin(count + 1, entries.size());
+}
+
+bool SnapshotRing::rewind(quint32 ticksBack, quint32 currentTick, GameSimulation &simulation,
+                          quint32 &restoredTick)
+{
+    if (count == 0) return false;
+
+    const quint32 target = currentTick > ticksBack ? currentTick - ticksBack : 0;
+    int age = 0;
+    while (age < count - 1 && entries[indexFromNewest(age)].tick > target) {
+        ++age;
+    }
+
+    const Entry &entry = entries[indexFromNewest(age)];
+    if (!simulation.restoreState(entry.state)) return false;
+    restoredTick = entry.tick;
+
+    // Восстановленный снимок остаётся в кольце: повторная перемотка
+    // уходит дальше в прошлое от него
+    next = (indexFromNewest(age) + 1) % entries.size();
+    count -= age;
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef SNAPSHOTRING_H
+#define SNAPSHOTRING_H
+
+#include <QByteArray>
+#include <QVector>
+
+class GameSimulation;
+
+// Кольцо последних двоичных снимков GameSimulation для перемотки назад.
+// Буферы вытесняемых снимков переиспользуются, поэтому после заполнения
+// кольца push() не выделяет память (пока снимки не растут).
+class SnapshotRing
+{
+public:
+    // Снимок раз в Interval шагов: 80 снимков покрывают ~5 с игры
+    static constexpr quint32 Interval = 4;
+
+    explicit SnapshotRing(int capacity = 80);
+
+    void clear();
+    int size() const { return count; }
+    int capacity() const { return entries.size(); }
+
+    // Снимок состояния после шага tick; самый старый вытесняется
+    void push(quint32 tick, const GameSimulation &simulation);
+
+    // Восстанавливает последний снимок не позднее currentTick - ticksBack
+    // (или самый старый, если кольцо короче) и отбрасывает более новые.
+    // false — кольцо пусто или снимок не прочитан.
+    bool rewind(quint32 ticksBack, quint32 currentTick, GameSimulation &simulation,
+                quint32 &restoredTick);
+
+private:
+    struct Entry {
+        quint32 tick = 0;
+        QByteArray state;
+    };
+
+    int indexFromNewest(int age) const;
+
+    QVector<Entry> entries;
+    int next = 0;
+    int count = 0;
+};
+
+#endif // SNAPSHOTRING_H
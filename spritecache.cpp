@@ -0,0 +1,239 @@
+#include "spritecache.h"
+#include "player.h"
+#include "workstealingpool.h"
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <QtMath>
+
+namespace {
+// Зазор между спрайтами в атласе, чтобы сглаживание не захватывало соседей
+const int AtlasPadding = 2;
+
+int spriteSize(int spriteId)
+{
+    return spriteId == SpriteCache::PLAYER ? Player::SpriteSize : Obstacle::SpriteSize;
+}
+
+// Спрайты с надписями: шрифты вне потока GUI рисуются не на всех платформах
+bool drawsText(int spriteId)
+{
+    return spriteId == Obstacle::BOMB;
+}
+
+// Спрайт в масштабе ratio; вызывается на потоках пула
+QImage rasterize(int spriteId, qreal ratio)
+{
+    const int pixels = qCeil(spriteSize(spriteId) * ratio);
+    QImage image(pixels, pixels, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    // Тот же рисунок в логических координатах, но с детализацией экрана
+    painter.scale(ratio, ratio);
+    if (spriteId == SpriteCache::PLAYER) {
+        Player::paintFace(&painter);
+    } else {
+        Obstacle::paintSprite(&painter, static_cast<Obstacle::ObstacleType>(spriteId));
+    }
+    painter.end();
+    return image;
+}
+}
+
+SpriteCache &SpriteCache::instance()
+{
+    static SpriteCache cache;
+    return cache;
+}
+
+void SpriteCache::prepare(const QVector<qreal> &ratios)
+{
+    QElapsedTimer total;
+    total.start();
+
+    if (rects.isEmpty()) {
+        // Раскладываем спрайты в одну полосу (логические единицы)
+        rects.resize(SpriteCount);
+        int x = AtlasPadding;
+        for (int id = 0; id < SpriteCount; ++id) {
+            const int size = spriteSize(id);
+            rects[id] = QRect(x, AtlasPadding, size, size);
+            x += size + AtlasPadding;
+        }
+    }
+
+    QVector<qreal> pending;
+    if (findSet(1.0) < 0) {
+        pending.append(1.0);
+    }
+    for (qreal ratio : ratios) {
+        bool known = ratio <= 0.0 || findSet(ratio) >= 0;
+        for (qreal queued : pending) {
+            known = known || qFuzzyCompare(queued, ratio);
+        }
+        if (!known) {
+            pending.append(ratio);
+        }
+    }
+    if (pending.isEmpty()) return;
+
+    // Каждый спрайт каждого масштаба — отдельная задача. QImage и QPainter
+    // по QImage работают вне потока GUI, QPixmap — нет. Текст — только если
+    // платформа поддерживает отрисовку шрифтов в потоках, иначе спрайты
+    // с надписями рисуются в этом потоке, пока пул занят остальными
+    QVector<QImage> images(pending.size() * SpriteCount);
+    QElapsedTimer raster;
+    raster.start();
+    {
+        const bool threadedText = QFontDatabase::supportsThreadedFontRendering();
+        // Каждая задача пишет только свой элемент
+        QImage *out = images.data();
+        WorkStealingPool pool(qMin(images.size(), qMax(1, QThread::idealThreadCount())));
+        QVector<int> local;
+        for (int i = 0; i < images.size(); ++i) {
+            const int id = i % SpriteCount;
+            const qreal ratio = pending[i / SpriteCount];
+            if (!threadedText && drawsText(id)) {
+                local.append(i);
+                continue;
+            }
+            pool.submit([out, i, id, ratio]() { out[i] = rasterize(id, ratio); });
+        }
+        for (int i : local) {
+            out[i] = rasterize(i % SpriteCount, pending[i / SpriteCount]);
+        }
+        pool.waitForAll();
+        preparationStats.threads = qMax(preparationStats.threads, pool.threadCount());
+    }
+    preparationStats.rasterMs += raster.nsecsElapsed() / 1e6;
+
+    // Поток GUI: атлас каждого масштаба собирается из готовых картинок,
+    // и каждая картинка один раз загружается в QPixmap
+    QElapsedTimer upload;
+    upload.start();
+    for (int p = 0; p < pending.size(); ++p) {
+        SpriteSet set;
+        set.ratio = pending[p];
+        set.sources.resize(SpriteCount);
+        set.pixmaps.resize(SpriteCount);
+
+        int atlasWidth = 0;
+        int atlasHeight = 0;
+        for (int id = 0; id < SpriteCount; ++id) {
+            const QImage &image = images[p * SpriteCount + id];
+            set.sources[id] = QRect(qRound(rects[id].x() * set.ratio), qRound(rects[id].y() * set.ratio),
+                                    image.width(), image.height());
+            atlasWidth = qMax(atlasWidth, set.sources[id].right() + 1);
+            atlasHeight = qMax(atlasHeight, set.sources[id].bottom() + 1);
+        }
+        const int padding = qCeil(AtlasPadding * set.ratio);
+        QImage atlasImage(atlasWidth + padding, atlasHeight + padding, QImage::Format_ARGB32_Premultiplied);
+        atlasImage.fill(Qt::transparent);
+        QPainter painter(&atlasImage);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (int id = 0; id < SpriteCount; ++id) {
+            const QImage &image = images[p * SpriteCount + id];
+            painter.drawImage(set.sources[id].topLeft(), image);
+            set.pixmaps[id] = QPixmap::fromImage(image);
+            set.pixmaps[id].setDevicePixelRatio(set.ratio);
+        }
+        painter.end();
+        set.atlas = QPixmap::fromImage(atlasImage);
+
+        if (qFuzzyCompare(set.ratio, 1.0)) {
+            masks.resize(SpriteCount);
+            for (int id = 0; id < SpriteCount; ++id) {
+                masks[id] = CollisionMask::fromImage(images[p * SpriteCount + id]);
+            }
+        }
+        sets.append(set);
+    }
+    preparationStats.uploadMs += upload.nsecsElapsed() / 1e6;
+
+    preparationStats.images += images.size();
+    missCount += static_cast<quint64>(images.size());
+    if (activeIndex < 0) {
+        activeIndex = findSet(1.0);
+    }
+    preparationStats.totalMs += total.nsecsElapsed() / 1e6;
+}
+
+void SpriteCache::ensureBuilt()
+{
+    if (activeIndex < 0) {
+        prepare(QVector<qreal>());
+    }
+}
+
+int SpriteCache::findSet(qreal ratio) const
+{
+    for (int i = 0; i < sets.size(); ++i) {
+        if (qFuzzyCompare(sets[i].ratio, ratio)) return i;
+    }
+    return -1;
+}
+
+const SpriteCache::SpriteSet &SpriteCache::activeSet()
+{
+    ensureBuilt();
+    return sets[activeIndex];
+}
+
+void SpriteCache::setDevicePixelRatio(qreal ratio)
+{
+    if (ratio <= 0.0) return;
+    prepare(QVector<qreal>{ratio});
+    activeIndex = findSet(ratio);
+}
+
+qreal SpriteCache::devicePixelRatio() const
+{
+    return activeIndex < 0 ? 1.0 : sets[activeIndex].ratio;
+}
+
+QPixmap SpriteCache::pixmap(int spriteId)
+{
+    if (spriteId < 0 || spriteId >= SpriteCount) return QPixmap();
+
+    if (activeIndex >= 0) {
+        ++hitCount;
+    }
+    return activeSet().pixmaps[spriteId];
+}
+
+QPixmap SpriteCache::obstaclePixmap(Obstacle::ObstacleType type)
+{
+    return pixmap(static_cast<int>(type));
+}
+
+QPixmap SpriteCache::playerPixmap()
+{
+    return pixmap(PLAYER);
+}
+
+const QVector<CollisionMask> &SpriteCache::collisionMasks()
+{
+    ensureBuilt();
+    return masks;
+}
+
+const QPixmap &SpriteCache::atlas()
+{
+    return activeSet().atlas;
+}
+
+QPainter::PixmapFragment SpriteCache::fragment(int spriteId, const QPointF &topLeft, qreal opacity)
+{
+    const SpriteSet &set = activeSet();
+    const QRect &rect = rects[spriteId];
+    const QRect &source = set.sources[spriteId];
+    // Источник задаётся в пикселях атласа, масштаб возвращает логический
+    // размер; create() принимает центр фрагмента
+    return QPainter::PixmapFragment::create(
+        QPointF(topLeft.x() + rect.width() / 2.0, topLeft.y() + rect.height() / 2.0), source,
+        rect.width() / static_cast<qreal>(source.width()),
+        rect.height() / static_cast<qreal>(source.height()), 0, opacity);
+}
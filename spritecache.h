@@ -0,0 +1,89 @@
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+#include <QVector>
+#include "obstacle.h"
+#include "collisionmask.h"
+
+// Сводка подготовки спрайтов (SpriteCache::prepare()), миллисекунды
+struct SpritePreparation {
+    int images = 0;         // растеризовано картинок (спрайт x масштаб)
+    int threads = 0;        // потоков растеризации
+    double rasterMs = 0.0;  // растеризация в QImage на потоках пула
+    double uploadMs = 0.0;  // сборка атласов и перевод в QPixmap в потоке GUI
+    double totalMs = 0.0;
+};
+
+// Общий для процесса кэш спрайтов.
+// Спрайты растеризуются заранее для каждого нужного devicePixelRatio:
+// рисование идёт в QImage на потоках пула (спрайты с текстом — в потоке GUI,
+// если платформа не рисует шрифты в потоках), а в потоке GUI картинки один
+// раз собираются в атлас и переводятся в QPixmap. Объекты получают
+// неявно разделяемые QPixmap активного масштаба, так что спавн
+// препятствия не рисует ничего.
+class SpriteCache
+{
+public:
+    // Идентификатор спрайта совпадает с GameObject::getType(): 0 — игрок, 1..4 — препятствия
+    enum SpriteId { PLAYER = 0, SpriteCount = Obstacle::STAR + 1 };
+
+    static SpriteCache &instance();
+
+    // Растеризует наборы для масштабов, которых ещё нет (масштаб 1 — всегда:
+    // по нему строятся маски столкновений). Вызывается из потока GUI
+    void prepare(const QVector<qreal> &ratios);
+    const SpritePreparation &preparation() const { return preparationStats; }
+
+    // Масштаб, в котором выдаются pixmap() и атлас; при необходимости
+    // набор для него подготавливается. Уже выданные QPixmap не меняются
+    void setDevicePixelRatio(qreal ratio);
+    qreal devicePixelRatio() const;
+
+    QPixmap obstaclePixmap(Obstacle::ObstacleType type);
+    QPixmap playerPixmap();
+    QPixmap pixmap(int spriteId);
+
+    // Маски непрозрачных пикселей для точной проверки столкновений
+    const QVector<CollisionMask> &collisionMasks();
+
+    // Атлас активного масштаба (в пикселях устройства) для пакетной отрисовки
+    const QPixmap &atlas();
+    // Фрагмент атласа для drawPixmapFragments(): спрайт логического
+    // размера с левым верхним углом в topLeft
+    QPainter::PixmapFragment fragment(int spriteId, const QPointF &topLeft, qreal opacity = 1.0);
+
+    // Счётчики: hits — выдача готового спрайта, misses — растеризация спрайта
+    quint64 hits() const { return hitCount; }
+    quint64 misses() const { return missCount; }
+
+private:
+    // Спрайты одного масштаба
+    struct SpriteSet {
+        qreal ratio = 1.0;
+        QPixmap atlas;
+        QVector<QRect> sources;   // прямоугольники в атласе, пиксели устройства
+        QVector<QPixmap> pixmaps; // с devicePixelRatio == ratio
+    };
+
+    SpriteCache() = default;
+    SpriteCache(const SpriteCache &) = delete;
+    SpriteCache &operator=(const SpriteCache &) = delete;
+
+    void ensureBuilt();
+    int findSet(qreal ratio) const;
+    const SpriteSet &activeSet();
+
+    QVector<QRect> rects;
+    QVector<SpriteSet> sets;
+    int activeIndex = -1;
+    QVector<CollisionMask> masks;
+    SpritePreparation preparationStats;
+
+    quint64 hitCount = 0;
+    quint64 missCount = 0;
+};
+
+#endif // SPRITECACHE_H
@@ -0,0 +1,56 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Кольцевая очередь без блокировок для одного писателя и одного читателя.
+// push() вызывается только из потока-писателя, pop() — только из потока-
+// читателя. Ёмкость фиксирована (степень двойки), память не выделяется;
+// при переполнении push() возвращает false.
+template <typename T, int Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0,
+                  "Ёмкость SpscQueue должна быть степенью двойки");
+
+public:
+    bool push(const T &value)
+    {
+        const quint32 t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[t & Mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value)
+    {
+        const quint32 h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = items[h & Mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr quint32 Mask = Capacity - 1;
+    static constexpr int CacheLine = 64;
+    static constexpr int IndexPadding = CacheLine - static_cast<int>(sizeof(std::atomic<quint32>));
+
+    // Индексы в разных строках кэша, чтобы потоки не мешали друг другу.
+    // Разносятся явными промежутками, а не alignas(64): до C++17 new
+    // не гарантирует такого выравнивания, а очередь лежит в объекте из new
+    char leadPadding[CacheLine];
+    std::atomic<quint32> head{0};
+    char headPadding[IndexPadding];
+    std::atomic<quint32> tail{0};
+    char tailPadding[IndexPadding];
+    T items[Capacity];
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,56 @@
+#include "sweptaabb.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+// Интервал времени, когда отрезок [minA, minA + sizeA) сдвигаемый на delta
+// перекрывает [minB, minB + sizeB). Возвращает false, если перекрытия нет.
+bool axisInterval(double minA, double sizeA, double delta,
+                  double minB, double sizeB, double &enter, double &exit)
+{
+    const double gapLow = minB - (minA + sizeA);  // при delta > 0 — до входа
+    const double gapHigh = (minB + sizeB) - minA; // при delta > 0 — до выхода
+
+    if (delta == 0.0) {
+        // Без движения по оси: перекрытие либо всё время, либо никогда
+        if (gapLow < 0.0 && gapHigh > 0.0) {
+            enter = -std::numeric_limits<double>::infinity();
+            exit = std::numeric_limits<double>::infinity();
+            return true;
+        }
+        return false;
+    }
+
+    const double t1 = gapLow / delta;
+    const double t2 = gapHigh / delta;
+    enter = std::min(t1, t2);
+    exit = std::max(t1, t2);
+    return true;
+}
+}
+
+SweepResult sweepAabb(const QRectF &moving, const QPointF &displacement, const QRectF &target)
+{
+    SweepResult result;
+
+    double enterX, exitX, enterY, exitY;
+    if (!axisInterval(moving.x(), moving.width(), displacement.x(),
+                      target.x(), target.width(), enterX, exitX)) {
+        return result;
+    }
+    if (!axisInterval(moving.y(), moving.height(), displacement.y(),
+                      target.y(), target.height(), enterY, exitY)) {
+        return result;
+    }
+
+    const double enter = std::max(enterX, enterY);
+    const double exit = std::min(exitX, exitY);
+    if (enter >= exit || enter >= 1.0 || exit <= 0.0) {
+        return result;
+    }
+
+    result.hit = true;
+    result.enter = std::max(0.0, enter);
+    result.exit = std::min(1.0, exit);
+    return result;
+}
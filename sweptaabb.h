@@ -0,0 +1,21 @@
+#ifndef SWEPTAABB_H
+#define SWEPTAABB_H
+
+#include <QPointF>
+#include <QRectF>
+
+// Результат проверки движущегося AABB против неподвижного.
+// enter и exit — доли перемещения, в пределах которых прямоугольники
+// пересекаются (открытый интервал, как в QRectF::intersects)
+struct SweepResult {
+    bool hit = false;
+    double enter = 0.0;
+    double exit = 1.0;
+};
+
+// Непрерывная проверка: moving смещается на displacement за шаг,
+// target неподвижен. Чтобы учесть движение обоих, displacement задаётся
+// относительным. Не пропускает пересечения при любой длине смещения.
+SweepResult sweepAabb(const QRectF &moving, const QPointF &displacement, const QRectF &target);
+
+#endif // SWEPTAABB_H
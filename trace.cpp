@@ -0,0 +1,207 @@
+#include "trace.h"
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+// 64K событий по 32 байта — 2 МБ на поток, несколько секунд плотной записи
+const quint64 BufferCapacity = 1 << 16;
+const quint64 BufferMask = BufferCapacity - 1;
+
+// Событие в кольце — четыре слова. Атомарные операции relaxed компилируются
+// в обычные записи, но выгрузка из другого потока не становится гонкой
+struct Slot {
+    std::atomic<qint64> timeNs;
+    std::atomic<qint64> durationNs;
+    std::atomic<quint64> args;
+    std::atomic<quint64> kind;
+};
+static_assert(sizeof(Slot) == 32, "Слот трассы должен занимать 32 байта");
+
+struct ThreadBuffer {
+    int id = 0;
+    QByteArray name;
+    std::atomic<quint64> head{0};
+    std::unique_ptr<Slot[]> slots{new Slot[BufferCapacity]};
+};
+
+// Кольца не удаляются и после завершения потока, чтобы его события
+// попали в выгрузку. Мьютекс — только при появлении нового потока и выгрузке
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+thread_local ThreadBuffer *localBuffer = nullptr;
+
+ThreadBuffer *threadBuffer()
+{
+    if (!localBuffer) {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->id = static_cast<int>(registry.size()) + 1;
+        buffer->name = "thread-" + QByteArray::number(buffer->id);
+        localBuffer = buffer.get();
+        registry.push_back(std::move(buffer));
+    }
+    return localBuffer;
+}
+
+// Имена аргументов мгновенных событий для JSON
+struct ArgNames {
+    const char *first;
+    const char *second;
+};
+
+ArgNames argNames(Trace::Kind kind)
+{
+    switch (kind) {
+    case Trace::Spawn: return { "type", "slot" };
+    case Trace::Hit: return { "type", "lives" };
+    case Trace::Pickup: return { "type", "score" };
+    case Trace::Miss: return { "type", "slot" };
+    case Trace::Difficulty: return { "spawnIntervalMs", "speedFactorPermille" };
+    case Trace::GameOver: return { "score", nullptr };
+    case Trace::Rewind: return { "ticks", nullptr };
+    default: return { nullptr, nullptr };
+    }
+}
+
+QByteArray microseconds(qint64 ns)
+{
+    return QByteArray::number(ns / 1000.0, 'f', 3);
+}
+}
+
+std::atomic<bool> Trace::active{false};
+
+const QElapsedTimer &Trace::clock()
+{
+    static const QElapsedTimer timer = [] {
+        QElapsedTimer started;
+        started.start();
+        return started;
+    }();
+    return timer;
+}
+
+void Trace::setThreadName(const char *name)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->name = name;
+}
+
+void Trace::record(Kind kind, qint64 timeNs, qint64 durationNs, qint32 arg0, qint32 arg1)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    const quint64 index = buffer->head.load(std::memory_order_relaxed);
+    Slot &slot = buffer->slots[index & BufferMask];
+    slot.timeNs.store(timeNs, std::memory_order_relaxed);
+    slot.durationNs.store(durationNs, std::memory_order_relaxed);
+    slot.args.store(static_cast<quint32>(arg0) | (quint64(static_cast<quint32>(arg1)) << 32),
+                    std::memory_order_relaxed);
+    slot.kind.store(kind, std::memory_order_relaxed);
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+const char *Trace::kindName(Kind kind)
+{
+    switch (kind) {
+    case Frame: return "frame";
+    case Tick: return "tick";
+    case Paint: return "paint";
+    case Autopilot: return "autopilot";
+    case Spawn: return "spawn";
+    case Hit: return "hit";
+    case Pickup: return "pickup";
+    case Miss: return "miss";
+    case Difficulty: return "difficulty";
+    case GameOver: return "game over";
+    case Rewind: return "rewind";
+    case KindCount: break;
+    }
+    return "?";
+}
+
+bool Trace::writeChromeJson(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    // Выгрузка может содержать сотни тысяч событий, поэтому JSON пишется
+    // потоком, без построения QJsonDocument
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    QVector<Event> copy;
+    for (const std::unique_ptr<ThreadBuffer> &buffer : registry) {
+        const QByteArray tid = QByteArray::number(buffer->id);
+        separator();
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+               + ",\"args\":{\"name\":\"" + buffer->name + "\"}}";
+
+        // Копия кольца; события, которые поток мог затереть за время
+        // копирования, отбрасываются по повторно прочитанной голове
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        const quint64 begin = head > BufferCapacity ? head - BufferCapacity : 0;
+        copy.resize(static_cast<int>(head - begin));
+        for (quint64 i = begin; i < head; ++i) {
+            const Slot &slot = buffer->slots[i & BufferMask];
+            const quint64 args = slot.args.load(std::memory_order_relaxed);
+            Event &event = copy[static_cast<int>(i - begin)];
+            event.timeNs = slot.timeNs.load(std::memory_order_relaxed);
+            event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+            event.arg0 = static_cast<qint32>(static_cast<quint32>(args));
+            event.arg1 = static_cast<qint32>(static_cast<quint32>(args >> 32));
+            event.kind = static_cast<quint8>(slot.kind.load(std::memory_order_relaxed));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const quint64 headAfter = buffer->head.load(std::memory_order_acquire);
+        // Поток может быть посреди записи события headAfter, а его слот тот же,
+        // что у события headAfter - BufferCapacity: его тоже нельзя доверять
+        const quint64 valid = headAfter >= BufferCapacity ? headAfter - BufferCapacity + 1 : 0;
+        const int skip = static_cast<int>(qMin<quint64>(valid > begin ? valid - begin : 0, copy.size()));
+
+        for (int i = skip; i < copy.size(); ++i) {
+            const Event &event = copy[i];
+            const Kind kind = static_cast<Kind>(event.kind);
+            separator();
+            out += "{\"name\":\"";
+            out += kindName(kind);
+            out += "\",\"cat\":\"game\",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + microseconds(event.timeNs);
+            if (event.durationNs >= 0) {
+                out += ",\"ph\":\"X\",\"dur\":" + microseconds(event.durationNs);
+            } else {
+                out += ",\"ph\":\"i\",\"s\":\"t\"";
+                const ArgNames names = argNames(kind);
+                if (names.first) {
+                    out += ",\"args\":{\"";
+                    out += names.first;
+                    out += "\":" + QByteArray::number(event.arg0);
+                    if (names.second) {
+                        out += ",\"";
+                        out += names.second;
+                        out += "\":" + QByteArray::number(event.arg1);
+                    }
+                    out += "}";
+                }
+            }
+            out += "}";
+        }
+
+        if (out.size() > (1 << 20)) {
+            file.write(out);
+            out.resize(0);
+        }
+    }
+    out += "\n]}\n";
+    file.write(out);
+    return file.error() == QFileDevice::NoError;
+}
@@ -0,0 +1,96 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+
+// Трасса событий для разбора подвисаний по временной шкале.
+// Каждый поток пишет события фиксированного размера в собственное кольцо
+// без блокировок и выделения памяти (запись — несколько наносекунд);
+// кольцо хранит последние события, как бортовой самописец. По запросу
+// трасса выгружается в формате Chrome Trace Event JSON для Perfetto
+// (ui.perfetto.dev) и chrome://tracing.
+class Trace
+{
+public:
+    enum Kind : quint8 {
+        // Участки с длительностью
+        Frame,      // кадр: таймер отрисовки целиком
+        Tick,       // шаг симуляции
+        Paint,      // отрисовка сцены
+        Autopilot,  // решение бота
+        // Мгновенные события
+        Spawn,      // тип, слот
+        Hit,        // тип, оставшиеся жизни
+        Pickup,     // тип, счёт
+        Miss,       // тип, слот
+        Difficulty, // интервал спавна, мс; множитель скорости x1000
+        GameOver,   // счёт
+        Rewind,     // на сколько шагов назад
+        KindCount
+    };
+
+    struct Event {
+        qint64 timeNs;      // начало по часам трассы
+        qint64 durationNs;  // -1 — мгновенное событие
+        qint32 arg0;
+        qint32 arg1;
+        quint8 kind;
+    };
+
+    // Выключенная трасса стоит одной проверки флага
+    static void setEnabled(bool enabled) { active.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return active.load(std::memory_order_relaxed); }
+
+    // Имя текущего потока в выгрузке; вызывать до первых событий потока
+    static void setThreadName(const char *name);
+
+    static qint64 nowNs() { return clock().nsecsElapsed(); }
+
+    static void complete(Kind kind, qint64 startNs, qint64 durationNs)
+    {
+        if (isEnabled()) record(kind, startNs, durationNs, 0, 0);
+    }
+    static void instant(Kind kind, qint32 arg0 = 0, qint32 arg1 = 0)
+    {
+        if (isEnabled()) record(kind, nowNs(), -1, arg0, arg1);
+    }
+
+    // Содержимое колец всех потоков в Chrome Trace Event JSON.
+    // Потоки продолжают писать: события, затёртые во время копирования,
+    // отбрасываются
+    static bool writeChromeJson(const QString &path);
+
+    static const char *kindName(Kind kind);
+
+private:
+    static void record(Kind kind, qint64 timeNs, qint64 durationNs, qint32 arg0, qint32 arg1);
+    static const QElapsedTimer &clock();
+
+    static std::atomic<bool> active;
+};
+
+// Участок трассы до конца области видимости
+class TraceScope
+{
+public:
+    explicit TraceScope(Trace::Kind kind)
+        : kind(kind), startNs(Trace::isEnabled() ? Trace::nowNs() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (startNs >= 0) Trace::complete(kind, startNs, Trace::nowNs() - startNs);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    Trace::Kind kind;
+    qint64 startNs;
+};
+
+#endif // TRACE_H
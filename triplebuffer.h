@@ -0,0 +1,47 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Тройной буфер без блокировок для одного писателя и одного читателя.
+// Писатель заполняет свой буфер и публикует его обменом со средним;
+// читатель забирает средний, если тот свежее его собственного. Ни одна
+// сторона не ждёт другую, читатель всегда видит целый последний
+// опубликованный кадр, а промежуточные кадры могут пропускаться.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Поток-писатель: буфер для заполнения и его публикация
+    T &writeBuffer() { return buffers[backIndex]; }
+    void publish()
+    {
+        const int previous = middle.exchange(backIndex | FreshBit, std::memory_order_acq_rel);
+        backIndex = previous & IndexMask;
+    }
+
+    // Поток-читатель: забирает последний опубликованный буфер.
+    // Возвращает false, если с прошлого вызова ничего не публиковалось.
+    // Ссылка readBuffer() действительна до следующего update()
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FreshBit)) {
+            return false;
+        }
+        const int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & IndexMask;
+        return true;
+    }
+    const T &readBuffer() const { return buffers[frontIndex]; }
+
+private:
+    static constexpr int IndexMask = 3;
+    static constexpr int FreshBit = 4;
+
+    T buffers[3];
+    int backIndex = 0;             // только писатель
+    std::atomic<int> middle{1};    // индекс и признак свежести
+    int frontIndex = 2;            // только читатель
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,117 @@
+#include "workstealingpool.h"
+#include <QThread>
+
+namespace {
+// Номер потока пула, в котором выполняется код; -1 — вне пула
+thread_local int currentWorker = -1;
+thread_local const WorkStealingPool *currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+    if (threadCount <= 0) {
+        threadCount = qMax(1, QThread::idealThreadCount());
+    }
+
+    workerCount = threadCount;
+    queues.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue));
+    }
+    threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    const int count = threadCount();
+    const int index = currentPool == this
+        ? currentWorker
+        : static_cast<int>(nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(count));
+
+    unfinished.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Под мьютексом ожидания, чтобы поток не уснул между проверкой и ожиданием
+        std::lock_guard<std::mutex> lock(idleMutex);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::waitForAll()
+{
+    std::unique_lock<std::mutex> lock(idleMutex);
+    allDone.wait(lock, [this] { return unfinished.load(std::memory_order_acquire) == 0; });
+}
+
+bool WorkStealingPool::popLocal(int index, Task &task)
+{
+    Queue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int index, Task &task)
+{
+    const int count = threadCount();
+    for (int offset = 1; offset < count; ++offset) {
+        Queue &queue = *queues[(index + offset) % count];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        stealCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int index)
+{
+    currentWorker = index;
+    currentPool = this;
+
+    Task task;
+    for (;;) {
+        if (popLocal(index, task) || steal(index, task)) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+            if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+        // Перехват через try_lock мог пропустить занятую очередь;
+        // пока задачи есть хоть где-то, поток не засыпает
+        if (queued.load(std::memory_order_acquire) > 0) continue;
+        if (stopping) return;
+        workAvailable.wait(lock, [this] {
+            return stopping || queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом работы.
+// У каждого потока своя очередь: владелец берёт задачи с конца (последние
+// добавленные, ещё горячие в кэше), а простаивающий поток забирает задачи
+// с начала чужой очереди. Задачи разной длины (например, игры, которые
+// заканчиваются через секунду или через десять минут) так распределяются
+// без центральной очереди, за которую конкурировали бы все потоки.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // threadCount <= 0 — по числу ядер
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    // Из потока пула задача попадает в его собственную очередь,
+    // извне — в очереди потоков по кругу
+    void submit(Task task);
+
+    // Ждёт завершения всех отправленных задач
+    void waitForAll();
+
+    int threadCount() const { return workerCount; }
+    // Сколько задач было перехвачено из чужих очередей
+    quint64 steals() const { return stealCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(int index);
+    bool popLocal(int index, Task &task);
+    bool steal(int index, Task &task);
+
+    // Число потоков задаётся до их запуска и дальше не меняется
+    int workerCount = 0;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::atomic<int> queued{0};      // задачи в очередях
+    std::atomic<int> unfinished{0};  // отправленные, но не завершённые
+    std::atomic<unsigned> nextQueue{0}; // беззнаковый: переполнение не даёт отрицательный индекс
+    std::atomic<quint64> stealCount{0};
+    bool stopping = false;
+
+    std::mutex idleMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+};
+
+#endif // WORKSTEALINGPOOL_H